@@ -6,13 +6,17 @@
 
 #include "_AnaIndex.hh"
 
+/// void, when type is well-formed (for SFINAE specialization)
+template<typename...>
+struct _anaidx_void { typedef void type; };
+
 /// Type-specific functions index,
 template<typename T, typename = void>
 class AnaIndex: virtual public _AnaIndex { };
 
 /// Specialize when ordering available
 template<typename T>
-class AnaIndex<T, typename T::ordering_t>: virtual public _AnaIndex {
+class AnaIndex<T, typename _anaidx_void<typename T::ordering_t>::type>: virtual public _AnaIndex {
 public:
     /// make type-appropriate ConfigCollator
     _ConfigCollator* makeConfigCollator(const Setting& S) const override;
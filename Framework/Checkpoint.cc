@@ -0,0 +1,117 @@
+/// @file Checkpoint.cc
+
+#include "Checkpoint.hh"
+#include "DiskBIO.hh"
+#include "MemBIO.hh"
+#include "TermColor.hh"
+#include <cstdio> // for std::rename, std::remove
+
+/// checkpoint file header tag
+static const string ckpt_magic = "MPM_CHECKPOINT";
+
+ChainCheckpoint::~ChainCheckpoint() {
+    if(writing.valid()) writing.wait();
+    for(auto& kv: stages) kv.second->ckpt = nullptr;
+}
+
+void ChainCheckpoint::add(Checkpointable& C, const string& key) {
+    std::lock_guard<std::mutex> lk(ckMut);
+    if(stages.count(key)) throw std::logic_error("Duplicate checkpoint stage '" + key + "'");
+    if(C.ckpt) throw std::logic_error("Stage '" + key + "' already assigned to a checkpoint");
+    C.ckpt = this;
+    C.ckpt_key = key;
+    stages.emplace(key, &C);
+}
+
+void ChainCheckpoint::save(const Checkpointable& C) {
+    BinarySerializer B;
+    C.saveState(B);
+
+    std::future<void> prev;
+    {
+        std::lock_guard<std::mutex> lk(ckMut);
+        auto& S = pending[C.ckpt_seq];
+        S[C.ckpt_key] = std::move(B.buf());
+        if(S.size() < stages.size()) return;
+
+        snapshot_t SS = std::move(S);
+        pending.erase(pending.begin(), pending.upper_bound(C.ckpt_seq)); // this and any older incomplete
+        if(write_busy) {    // replace any snapshot still waiting behind in-flight write
+            if(has_queued) ++n_coalesced;
+            queued = std::move(SS);
+            queued_seq = C.ckpt_seq;
+            has_queued = true;
+            return;
+        }
+        write_busy = true;
+        prev = std::move(writing);  // completed (not busy); collected outside lock
+        writing = std::async(std::launch::async, &ChainCheckpoint::writeQueue, this, C.ckpt_seq, std::move(SS));
+    }
+    if(prev.valid()) prev.get();    // re-throw any previous write error
+}
+
+void ChainCheckpoint::finish() {
+    std::future<void> w;
+    {
+        std::lock_guard<std::mutex> lk(ckMut);
+        w = std::move(writing);
+    }
+    if(w.valid()) w.get();
+}
+
+void ChainCheckpoint::writeQueue(size_t seq, snapshot_t S) {
+    while(true) {
+        try { write(fname, seq, S); }
+        catch(...) {
+            std::lock_guard<std::mutex> lk(ckMut);
+            write_busy = has_queued = false;
+            queued.clear();
+            throw;
+        }
+
+        std::lock_guard<std::mutex> lk(ckMut);
+        ++n_written;
+        if(!has_queued) {
+            write_busy = false;
+            return;
+        }
+        S = std::move(queued);
+        queued.clear();
+        seq = queued_seq;
+        has_queued = false;
+    }
+}
+
+void ChainCheckpoint::write(const string& f, size_t seq, const snapshot_t& S) {
+    auto ftmp = f + ".tmp";
+    std::remove(ftmp.c_str());
+    FDBinaryWriter W(ftmp);
+    W.start_wtx();
+    W.send(ckpt_magic);
+    W.send(seq);
+    W.send(S);
+    W.end_wtx();    // written and synced to disk before replacing previous checkpoint
+    W.closeOut();
+    if(std::rename(ftmp.c_str(), f.c_str())) throw std::runtime_error("Failed to replace checkpoint file '" + f + "'");
+}
+
+bool ChainCheckpoint::resume() {
+    FDBinaryReader R(fname);
+    if(!R.inIsOpen()) return false;
+
+    if(R.receive<string>() != ckpt_magic) throw std::runtime_error("'" + fname + "' is not a checkpoint file");
+    R.receive(seq_resumed);
+    snapshot_t S;
+    R.receive(S);
+
+    std::lock_guard<std::mutex> lk(ckMut);
+    for(auto& kv: stages) {
+        auto it = S.find(kv.first);
+        if(it == S.end()) throw std::runtime_error("Checkpoint '" + fname + "' missing state for '" + kv.first + "'");
+        MemBReader M(it->second.data(), it->second.size());
+        kv.second->restoreState(M);
+        kv.second->ckpt_seq = seq_resumed;
+    }
+    printf(TERMFG_BLUE "Resumed %zu stages from checkpoint %zu in '%s'" TERMSGR_RESET "\n", stages.size(), seq_resumed, fname.c_str());
+    return true;
+}
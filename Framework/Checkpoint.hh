@@ -0,0 +1,154 @@
+/// @file Checkpoint.hh Checkpoint/restart of analysis chain state
+
+#ifndef CHECKPOINT_HH
+#define CHECKPOINT_HH
+
+#include "SignalSink.hh"
+#include "BinaryIO.hh"
+#include <iterator> // for std::distance
+#include <mutex>
+#include <future>
+
+class ChainCheckpoint;
+
+/// Analysis stage state, saved at DATASTREAM_CHECKPT and restored to resume a chain
+class Checkpointable {
+public:
+    /// Polymorphic destructor
+    virtual ~Checkpointable() { }
+
+    /// serialize current state
+    virtual void saveState(BinaryWriter& B) const = 0;
+    /// restore state written by saveState
+    virtual void restoreState(BinaryReader& B) = 0;
+
+protected:
+    friend class ChainCheckpoint;
+
+    /// save state into assigned checkpoint; return false if unassigned (stage should flush instead)
+    bool takeCheckpoint();
+
+    ChainCheckpoint* ckpt = nullptr;    ///< checkpoint collecting this stage's state
+    string ckpt_key;                    ///< identifier for state within checkpoint
+    size_t ckpt_seq = 0;                ///< number of checkpoints taken
+};
+
+/// called when T::saveState defined
+template<typename T>
+auto save_imp(BinaryWriter& B, const T& o, int) -> decltype(o.saveState(B), void()) { o.saveState(B); }
+/// plain-data save
+template<typename T>
+typename std::enable_if<IS_TRIVIALLY_COPYABLE(T) && !std::is_pointer<T>::value>::type
+save_imp(BinaryWriter& B, const T& o, long) { B.send(o); }
+/// unserializable type
+template<typename T>
+typename std::enable_if<!IS_TRIVIALLY_COPYABLE(T) || std::is_pointer<T>::value>::type
+save_imp(BinaryWriter&, const T&, long) { throw std::logic_error("Checkpoint of object without saveState()"); }
+/// serialize object for checkpoint, with T::saveState if defined
+template<typename T>
+void saveObj(BinaryWriter& B, const T& o) { save_imp(B, o, 0); }
+
+/// called when T::restoreState defined
+template<typename T>
+auto restore_imp(BinaryReader& B, T& o, int) -> decltype(o.restoreState(B), void()) { o.restoreState(B); }
+/// plain-data restore
+template<typename T>
+typename std::enable_if<IS_TRIVIALLY_COPYABLE(T) && !std::is_pointer<T>::value>::type
+restore_imp(BinaryReader& B, T& o, long) { B.receive(o); }
+/// unserializable type
+template<typename T>
+typename std::enable_if<!IS_TRIVIALLY_COPYABLE(T) || std::is_pointer<T>::value>::type
+restore_imp(BinaryReader&, T&, long) { throw std::logic_error("Restore of object without restoreState()"); }
+/// deserialize object written by saveObj
+template<typename T>
+void restoreObj(BinaryReader& B, T& o) { restore_imp(B, o, 0); }
+
+/// serialize count and items in [i0, i1)
+template<typename It>
+void saveItems(BinaryWriter& B, It i0, It i1) {
+    B.send<size_t>(std::distance(i0, i1));
+    while(i0 != i1) saveObj(B, *(i0++));
+}
+
+/// restore new object into f(T&&): default-constructed, then restoreObj
+template<typename T, typename F>
+typename std::enable_if<std::is_default_constructible<T>::value>::type
+restore_new(BinaryReader& B, F& f) {
+    T o{};
+    restoreObj(B, o);
+    f(std::move(o));
+}
+/// restore new object into f(T&&): plain data without default constructor
+template<typename T, typename F>
+typename std::enable_if<!std::is_default_constructible<T>::value && IS_TRIVIALLY_COPYABLE(T)>::type
+restore_new(BinaryReader& B, F& f) {
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type d;
+    B.read(&d, sizeof(T));
+    f(std::move(*reinterpret_cast<T*>(&d)));
+}
+/// unrestorable type
+template<typename T, typename F>
+typename std::enable_if<!std::is_default_constructible<T>::value && !IS_TRIVIALLY_COPYABLE(T)>::type
+restore_new(BinaryReader&, F&) { throw std::logic_error("Restore of object without default constructor"); }
+
+/// deserialize items written by saveItems, passing each to f(T&&)
+template<typename T, typename F>
+void restoreItems(BinaryReader& B, F f) {
+    auto n = B.receive<size_t>();
+    while(n--) restore_new<T>(B, f);
+}
+
+/// Collects registered stages' states as each receives DATASTREAM_CHECKPT,
+/// writing each completed checkpoint to file in a background thread.
+/// Stages serialize to memory in place of their checkpoint flush; only the file write is deferred.
+/// All registered stages must receive the checkpoint signal for a checkpoint to complete.
+class ChainCheckpoint {
+public:
+    /// Constructor, with checkpoint file name
+    explicit ChainCheckpoint(const string& f): fname(f) { }
+    /// Destructor, completing pending file write
+    ~ChainCheckpoint();
+
+    /// register stage, with unique identifier for its state
+    void add(Checkpointable& C, const string& key);
+    /// request checkpoint: save source (read position), then signal chain
+    void request(Checkpointable& src, SignalSink& S) { src.takeCheckpoint(); S.signal(DATASTREAM_CHECKPT); }
+    /// restore all registered stages from checkpoint file; return false if no checkpoint present
+    bool resume();
+    /// wait for pending file writes, re-throwing any write error
+    void finish();
+
+    /// store stage state for its current checkpoint (called from stage's thread)
+    void save(const Checkpointable& C);
+
+    string fname;           ///< checkpoint file name
+    size_t n_written = 0;   ///< number of checkpoints written to file
+    size_t n_coalesced = 0; ///< number of checkpoints superseded by a newer one while awaiting write
+    size_t seq_resumed = 0; ///< checkpoint number restored by resume()
+
+protected:
+    /// serialized states by stage identifier
+    typedef map<string, vector<char>> snapshot_t;
+    /// write snapshot to temporary file, then replace checkpoint file
+    static void write(const string& f, size_t seq, const snapshot_t& S);
+    /// background writer: write snapshot, then any newer snapshot queued meanwhile
+    void writeQueue(size_t seq, snapshot_t S);
+
+    map<string, Checkpointable*> stages;    ///< registered stages, by identifier
+    map<size_t, snapshot_t> pending;        ///< incomplete checkpoints, by sequence number
+    std::mutex ckMut;                       ///< lock on pending, writing, queued
+    std::future<void> writing;              ///< background file write
+    bool write_busy = false;                ///< whether background write is in progress
+    snapshot_t queued;                      ///< newest complete snapshot awaiting in-progress write
+    size_t queued_seq = 0;                  ///< sequence number of queued snapshot
+    bool has_queued = false;                ///< whether queued is waiting
+};
+
+inline bool Checkpointable::takeCheckpoint() {
+    if(!ckpt) return false;
+    ++ckpt_seq;
+    ckpt->save(*this);
+    return true;
+}
+
+#endif
@@ -5,6 +5,8 @@
 #define CLUSTERED_HH
 
 #include "SinkUser.hh"
+#include "AllocPool.hh"
+#include "Checkpoint.hh"
 #include <cmath> // for fabs()
 
 /// "Cluster" base class
@@ -27,6 +29,14 @@ public:
     explicit Cluster(ordering_t w = {}): dx(w) { }
     /// Polymorphic destructor
     virtual ~Cluster() { }
+    /// Copy constructor
+    Cluster(const Cluster&) = default;
+    /// Move constructor (taking contents storage)
+    Cluster(Cluster&&) = default;
+    /// Copy assignment
+    Cluster& operator=(const Cluster&) = default;
+    /// Move assignment (taking contents storage)
+    Cluster& operator=(Cluster&&) = default;
 
     /// Get ordering parameter
     explicit operator ordering_t() const { return x_median; }
@@ -54,6 +64,18 @@ public:
     /// Clear contents
     virtual void clear() { super_t::clear(); }
 
+    /// serialize contents (e.g. for checkpoint); override to add subclass state
+    virtual void saveState(BinaryWriter& B) const {
+        B << dx << x_median;
+        saveItems(B, begin(), end());
+    }
+    /// restore contents written by saveState
+    virtual void restoreState(BinaryReader& B) {
+        clear();
+        B >> dx >> x_median;
+        restoreItems<contents_t>(B, [this](contents_t&& o) { push_back(std::move(o)); });
+    }
+
     /// sort contents by ordering parameter
     void sort() { std::sort(begin(), end(), [this](const contents_t& a, const contents_t& b) { return ordering_t(a) < ordering_t(b); }); }
 
@@ -79,7 +101,7 @@ protected:
 
 /// Cluster builder; input always const, output const-ness determined from C
 template<class C>
-class ClusterBuilder: public DataLink<const typename C::contents_t, C> {
+class ClusterBuilder: public DataLink<const typename C::contents_t, C>, public Checkpointable {
 public:
     typedef C cluster_t;
     typedef typename std::remove_const<cluster_t>::type cmut_t;
@@ -91,17 +113,19 @@ public:
 
     /// accept data flow signal
     void signal(datastream_signal_t sig) override {
-        if(sig >= DATASTREAM_FLUSH) {
+        bool saved = sig == DATASTREAM_CHECKPT && this->takeCheckpoint(); // keeps cluster in progress
+        if(sig >= DATASTREAM_FLUSH && !saved) {
             completeCluster();
             t_prev = -C::order_max;
         }
         if(this->nextSink) this->nextSink->signal(sig);
     }
 
-    /// push currentC into window
+    /// push currentC into window; downstream may take (move) its contents, replaced from recycling pool
     void completeCluster() {
         currentC.close();
         if(currentC.size() && checkCluster(currentC) && this->nextSink) this->nextSink->push(currentC);
+        if(!currentC.capacity()) RecyclePool<cmut_t>::get(currentC);
         currentC.clear();
     }
 
@@ -122,6 +146,22 @@ public:
         }
     }
 
+    /// add batch of ordered objects, without per-item dispatch
+    void push_batch(typename DataSink<const typename C::contents_t>::span_t v) override {
+        for(auto& o: v) ClusterBuilder::push(o);
+    }
+
+    /// save cluster in progress
+    void saveState(BinaryWriter& B) const override {
+        B << t_prev;
+        saveObj(B, currentC);
+    }
+    /// restore cluster in progress
+    void restoreState(BinaryReader& B) override {
+        B >> t_prev;
+        restoreObj(B, currentC);
+    }
+
     ordering_t cluster_dx{};            ///< time spread for cluster identification
 
 protected:
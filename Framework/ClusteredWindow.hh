@@ -7,35 +7,54 @@
 #include "OrderedWindow.hh"
 #include "Clustered.hh"
 
-/// Wrap ClusterBuilder in OrderedWindow
-template<class CB>
+/// Wrap ClusterBuilder in OrderedWindow (with optional window storage container type)
+template<class CB, class _container_t = deque<typename std::remove_const<typename CB::cluster_t>::type>>
 class CBWindow: public PreSink<CB>,
-public OrderedWindow<typename CB::cluster_t> {
+public OrderedWindow<typename CB::cluster_t, typename CB::cluster_t::ordering_t, _container_t> {
 public:
     typedef CB clustbuilder_t;
     typedef typename clustbuilder_t::cluster_t cluster_t;
     typedef typename cluster_t::ordering_t ordering_t;
-    typedef OrderedWindow<cluster_t> window_t;
+    typedef OrderedWindow<cluster_t, ordering_t, _container_t> window_t;
 
     /// Constuctor with pass-through args
     template<typename... Args>
     explicit CBWindow(ordering_t dw, Args&&... a):
-    PreSink<CB>(std::forward<Args>(a)...), window_t(dw) { }
+    PreSink<CB>(std::forward<Args>(a)...), window_t(dw) { this->recycleOld = true; }
 
     using PreSink<CB>::push;
 
-    /// receive signals
-    void signal(datastream_signal_t s) override { PreSink<CB>::signal(s); }
+    /// receive signals; checkpoint saves builder with window, without completing current cluster
+    void signal(datastream_signal_t s) override {
+        if(s == DATASTREAM_CHECKPT && this->takeCheckpoint()) return;
+        PreSink<CB>::signal(s);
+    }
+
+    /// save window and cluster builder states
+    void saveState(BinaryWriter& B) const override {
+        window_t::saveState(B);
+        this->PreTransform.saveState(B);
+    }
+    /// restore window and cluster builder states
+    void restoreState(BinaryReader& B) override {
+        window_t::restoreState(B);
+        this->PreTransform.restoreState(B);
+    }
 
 protected:
-    using OrderedWindow<cluster_t>::push;
-    //using OrderedWindow<cluster_t>::signal;
+    using window_t::push;
+    //using window_t::signal;
 
     /// examine and decide whether to include cluster
     virtual bool checkCluster(cluster_t& o) { return o.size(); }
 
-    /// Receive pre-transformed input:
-    void _push(cluster_t& C) override { window_t::push(C); }
+    /// Receive pre-transformed input, taking contents of mutable clusters (builder refills from RecyclePool)
+    void _push(cluster_t& C) override { take(C); }
+    /// move mutable cluster into window
+    void take(typename window_t::Tmut_t& C) { window_t::push_take(C); }
+    /// copy const cluster into window
+    template<typename U>
+    void take(U& C) { window_t::push(C); }
     /// receive back signals
     void _signal(datastream_signal_t s) override { window_t::signal(s); }
 };
@@ -44,4 +63,8 @@ protected:
 template<class C>
 using ClusteredWindow = CBWindow<ClusterBuilder<C>>;
 
+/// ClusteredWindow with contiguous ring-buffer storage
+template<class C>
+using RingClusteredWindow = CBWindow<ClusterBuilder<C>, ring_deque<C>>;
+
 #endif
@@ -5,20 +5,23 @@
 #define CONFIGCOLLATOR_HH
 
 #include "_ConfigCollator.hh"
-#include "Collator.hh"
+#include "MergeCollator.hh"
 
 /// Configturation-buildable Collator object
 template<class T>
-class ConfigCollator: public _ConfigCollator, public Collator<T> {
+class ConfigCollator: public _ConfigCollator, public MergeCollator<T> {
 public:
     /// Constructor
     explicit ConfigCollator(const Setting& S): _ConfigCollator(S) {
+        int nq = this->queue_size;
+        Cfg.lookupValue("queue_size", nq, "per-input collation queue capacity");
+        this->queue_size = nq;
         if(S.exists("next")) createOutput(S["next"]);
     }
 };
 
 /// Registration in AnaIndex
 template<typename T>
-_ConfigCollator* AnaIndex<T,typename T::ordering_t>::makeConfigCollator(const Setting& S) const { return new ConfigCollator<T>(S); }
+_ConfigCollator* AnaIndex<T, typename _anaidx_void<typename T::ordering_t>::type>::makeConfigCollator(const Setting& S) const { return new ConfigCollator<T>(S); }
 
 #endif
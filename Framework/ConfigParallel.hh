@@ -9,6 +9,9 @@
 #include "ClusteredWindow.hh"
 #include "AnaIndex.hh"
 #include <thread>
+#include <atomic>
+#include <memory>
+#include <algorithm>
 
 /// Type-independent re-casting base
 class _ConfigParallel: public Configurable, public ThreadManager, public XMLProvider, public _SubSinkUser {
@@ -22,6 +25,15 @@ public:
     /// if run at top scope...
     void run() override;
 
+    /// policy for assigning clusters to parallel chains
+    enum dispatch_t {
+        DISPATCH_ROUNDROBIN,    ///< cycle through chains in turn
+        DISPATCH_LEASTLOADED,   ///< chain with fewest queued items
+        DISPATCH_STEAL          ///< least-loaded, plus idle chains steal queued clusters from busy ones
+    } dispatch = DISPATCH_ROUNDROBIN;   ///< cluster dispatch policy
+
+    placement_t placement = PLACE_NONE; ///< automatic CPU placement policy for parallel chain threads
+
 protected:
     int nparallel = 0;                  ///< number of parallel threads to run
     vector<_SinkUser*> vends;           ///< ends of parallel chains
@@ -33,15 +45,24 @@ protected:
 
     /// construct and attach appropriate myColl to vends
     void makeCollator();
+    /// assign physical cores, by placement policy, to threads without explicit placement
+    void placeThreads(const vector<Threadworker*>& v);
 
     /// XML metadata output
-    void _makeXML(XMLTag& X) override { X.addAttr("nparallel", nparallel); }
+    void _makeXML(XMLTag& X) override {
+        X.addAttr("nparallel", nparallel);
+        if(dispatch != DISPATCH_ROUNDROBIN) X.addAttr("dispatch", dispatch == DISPATCH_STEAL? "steal" : "leastloaded");
+        if(placement != PLACE_NONE) X.addAttr("placement", placement == PLACE_SPREAD? "spread" : "compact");
+    }
 };
 
 /// Configurable parallelize-and-collate process
 template<typename T, class CLUST = Clusterer<T>>
 class ConfigParallel: virtual public _ConfigParallel, public PreSink<CLUST> {
 public:
+    typedef typename CLUST::ordering_t ordering_t;
+    typedef ThreadBufferSink<T> lane_t;
+
     /// Constructor
     explicit ConfigParallel(const Setting& S): _ConfigParallel(S), PreSink<CLUST>(1000) {
         S.lookupValue("cluster_dt", this->PreTransform.cluster_dx);
@@ -56,6 +77,8 @@ public:
             else subSinker = vout.back();
 
             myColl->launch_mythread();
+            setupStealing();
+            placeThreads(vector<Threadworker*>(vout.begin(), vout.end()));
             for(auto c: vout) c->launch_mythread();
 
         } else { // end in parallel chains without collation back to single thread
@@ -66,6 +89,8 @@ public:
                 vout.back()->worker_id = --nth;
             } while(nth > 0);
 
+            setupStealing();
+            placeThreads(vector<Threadworker*>(vout.begin(), vout.end()));
             if(!nth) for(auto c: vout) c->launch_mythread();
         }
 
@@ -88,13 +113,17 @@ public:
         vends.back()->setOwnsNext(false);
     }
 
-    /// pass clustered inputs round-robin to parallel chains
+    /// pass clustered inputs to parallel chains, according to dispatch policy
     void _push(typename CLUST::cluster_t& C) override {
-        if(!vout.size()) return;
-        auto o = vout[(outn++) % vout.size()];
-        for(auto& p: C) o->push(p);
+        if(!vout.size() || !C.size()) return;
+        size_t j = (outn++) % vout.size();
+        if(dispatch != DISPATCH_ROUNDROBIN) j = leastLoaded(j);
+        if(dispatch == DISPATCH_STEAL) raise_order(j, ordering_t(C.back()));
+        vout[j]->push_batch(C);
     }
 
+    size_t nstolen() const { size_t n = 0; for(auto o: vout) n += o->n_stolen.load(); return n; } ///< number of clusters moved by work-stealing
+
     /// handle signals through pre-transform
     void _signal(datastream_signal_t s) override {
         for(auto& o: vout) o->signal(s);
@@ -103,7 +132,59 @@ public:
 
 protected:
     size_t outn = 0;                    ///< round-robin output index
-    vector<ThreadBufferSink<T>*> vout;  ///< outputs to parallel chains
+    vector<lane_t*> vout;               ///< outputs to parallel chains
+    std::unique_ptr<std::atomic<ordering_t>[]> last_order;  ///< latest ordering assigned to each chain, for work-stealing
+
+    /// chain with fewest queued items, preferring (rotating) start index j0 on ties
+    size_t leastLoaded(size_t j0) const {
+        size_t jmin = j0, dmin = vout[j0]->queue_depth();
+        for(size_t k = 1; k < vout.size() && dmin; ++k) {
+            size_t j = (j0 + k) % vout.size();
+            size_t d = vout[j]->queue_depth();
+            if(d < dmin) { dmin = d; jmin = j; }
+        }
+        return jmin;
+    }
+
+    /// advance latest ordering assigned to chain j (never moving backwards)
+    void raise_order(size_t j, ordering_t x) {
+        auto x0 = last_order[j].load();
+        while(x0 < x && !last_order[j].compare_exchange_weak(x0, x)) { }
+    }
+
+    /// configure work-stealing hooks between chains
+    void setupStealing() {
+        Cfg.lookupEnum("dispatch", dispatch, "parallel chain dispatch policy",
+                       {{"roundrobin", DISPATCH_ROUNDROBIN}, {"leastloaded", DISPATCH_LEASTLOADED}, {"steal", DISPATCH_STEAL}});
+        if(dispatch != DISPATCH_STEAL || vout.size() < 2) return;
+
+        last_order.reset(new std::atomic<ordering_t>[vout.size()]);
+        for(size_t j = 0; j < vout.size(); ++j) {
+            last_order[j] = -CLUST::cluster_t::order_max;
+            vout[j]->idle_poll_us = 1000;
+            vout[j]->steal_hook = [this, j](lane_t& me) { return stealFor(me, j); };
+        }
+    }
+
+    /// attempt to steal queued (not yet started) clusters into chain j, trying most-loaded chains first.
+    /// To keep each chain's output ordered for the collator, only clusters after everything
+    /// already assigned to j are accepted; clusters are never moved across queued signals.
+    bool stealFor(lane_t& me, size_t j) {
+        vector<std::pair<size_t, size_t>> vd;   // (depth, chain) for candidate victims
+        for(size_t k = 0; k < vout.size(); ++k) {
+            auto d = vout[k]->queue_depth();
+            if(k != j && d > 1) vd.emplace_back(d, k);
+        }
+        std::sort(vd.rbegin(), vd.rend());
+
+        auto ok = [this, j](const T& first, const T& last) {
+            if(!(last_order[j].load() < ordering_t(first))) return false;
+            raise_order(j, ordering_t(last));
+            return true;
+        };
+        for(auto& v: vd) if(me.steal_from(*vout[v.second], ok)) return true;
+        return false;
+    }
 };
 
 #endif
@@ -0,0 +1,33 @@
+/// @file ConfigPlacement.hh Configuration of worker thread CPU/NUMA placement
+
+#ifndef CONFIGPLACEMENT_HH
+#define CONFIGPLACEMENT_HH
+
+#include "Threadworker.hh"
+#include "PingpongBufferWorker.hh"
+#include "CPUPlacement.hh"
+#include "ExplainConfig.hh"
+#include "GlobalArgs.hh"
+
+/// Configure worker thread placement from "cpus" (cpulist string, e.g. "0-3,8") and "numa_node" settings,
+/// overridden by -threadCPUs and -numaNode global arguments
+inline void configurePlacement(Threadworker& W, SettingsQuery& Cfg) {
+    string cpus;
+    Cfg.lookupValue("cpus", cpus, "CPU list to run worker thread on (e.g. 0-3,8)");
+    optionalGlobalArg("threadCPUs", cpus, "CPU list for worker threads (e.g. 0-3,8)");
+    if(cpus.size()) W.cpus = parseCPUList(cpus);
+
+    Cfg.lookupValue("numa_node", W.numa_node, "NUMA node to run worker thread and allocate its buffers on (-1 for any)");
+    optionalGlobalArg("numaNode", W.numa_node, "NUMA node for worker threads (-1 for any)");
+}
+
+/// Configure buffered worker placement, plus "prealloc" items of buffer space first-touched by the placed worker thread
+template<typename T>
+void configurePlacement(PingpongBufferWorker<T>& W, SettingsQuery& Cfg) {
+    configurePlacement(static_cast<Threadworker&>(W), Cfg);
+    int n = W.prealloc;
+    if(Cfg.lookupValue("prealloc", n, "items of buffer space allocated by placed worker thread (0 for capacity, or "
+                       + std::to_string(W.prealloc_unbounded) + " if unlimited)")) W.prealloc = std::max(n, 0);
+}
+
+#endif
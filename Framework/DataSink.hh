@@ -5,6 +5,7 @@
 #define DATASINK_HH
 
 #include "SignalSink.hh"
+#include "span_view.hh"
 
 /// Virtual base class for accepting a stream of objects
 template<typename T>
@@ -14,8 +15,12 @@ public:
     typedef T sink_t;
     /// mutable variant of received data type
     typedef typename std::remove_const<T>::type mutsink_t;
+    /// contiguous batch of received data
+    typedef span_view<sink_t> span_t;
     /// take instance of object
     virtual void push(sink_t&) = 0;
+    /// take contiguous batch of objects, in order; override for native batch handling
+    virtual void push_batch(span_t v) { for(auto& o: v) push(o); }
 };
 
 #endif
@@ -5,36 +5,161 @@
 #define DATASINKTEE_HH
 
 #include "ConfigFactory.hh"
+#include "DataSink.hh"
 #include "XMLTag.hh"
+#include "SignalBufferWorker.hh"
+#include "BackpressureGate.hh"
+#include <memory>
 
 /// Tee input to multiple configured sinks
+/// In threaded mode ("threaded = true"), each branch runs on its own worker thread, receiving
+/// shared immutable batches (single pushes are grouped into batches of up to "batch" items).
+/// Each branch queue takes optional capacity/overflow/high_water/low_water/backpressure settings (counted in batches),
+/// from the tee's settings or per-branch overrides in the "branches" list (matching "next" order).
 template<typename T>
 class DataSinkTee: public DataSink<T>, virtual public XMLProvider {
 public:
     typedef T sink_t;
     typedef DataSink<T> dsink_t;
+    typedef typename dsink_t::mutsink_t mutsink_t;
+    /// shared immutable batch of items
+    typedef std::shared_ptr<const vector<mutsink_t>> batch_t;
 
     /// Constructor, from config file
     explicit DataSinkTee(const Setting& S): XMLProvider("DataSinkTee") {
-        if(!S.exists("next")) throw std::runtime_error("DataSinkTee missing 'next' outputs");
-        auto& nxt = S["next"];
+        SettingsQuery Cfg(S);
+        Cfg.markused("class");
+        if(!Cfg.exists("next")) throw std::runtime_error("DataSinkTee missing 'next' outputs");
+        auto& nxt = Cfg["next"];
         if(nxt.isList()) {
             for(auto& cfg: nxt)
                 sinks.push_back(constructCfgObj<dsink_t>(cfg, ""));
         } else sinks.push_back(constructCfgObj<dsink_t>(nxt, ""));
         for(auto s: sinks) tryAdd(s);
+
+        Cfg.lookupValue("threaded", threaded, "run each branch in its own thread");
+        if(!threaded) return;
+        int n = nbatch;
+        if(Cfg.lookupValue("batch", n, "maximum single items grouped into a shared batch")) nbatch = std::max(n, 1);
+        for(size_t i = 0; i < sinks.size(); ++i) branches.push_back(new Branch(*sinks[i], i));
+        configureBranch(Cfg, *branches[0]);
+        for(size_t i = 1; i < branches.size(); ++i) copyQueueSettings(*branches[0], *branches[i]);
+        if(!Cfg.exists("branches")) return;
+        auto& BS = Cfg["branches"];
+        for(int i = 0; i < BS.getLength() && i < int(branches.size()); ++i) {
+            SettingsQuery BCfg(BS[i]);
+            configureBranch(BCfg, *branches[i]);
+        }
     }
 
     /// Destructor
-    ~DataSinkTee() { for(auto s: sinks) delete s; }
+    ~DataSinkTee() {
+        for(auto b: branches) delete b;
+        for(auto s: sinks) delete s;
+    }
 
     /// take instance of object
-    void push(sink_t& x) override { for(auto s: sinks) s->push(x); }
+    void push(sink_t& x) override {
+        if(!running()) { for(auto s: sinks) s->push(x); return; }
+        pending.push_back(x);
+        if(pending.size() >= nbatch) flushPending();
+    }
+
+    /// take batch of objects
+    void push_batch(typename dsink_t::span_t v) override {
+        if(!running()) { for(auto s: sinks) s->push_batch(v); return; }
+        pending.insert(pending.end(), v.begin(), v.end());
+        if(pending.size() >= nbatch) flushPending();
+    }
+
     /// accept data flow signal
-    void signal(datastream_signal_t sig) override { for(auto s: sinks) s->signal(sig); }
+    void signal(datastream_signal_t sig) override {
+        if(!threaded) { for(auto s: sinks) s->signal(sig); return; }
+
+        if(sig == DATASTREAM_INIT) for(auto b: branches) if(!b->checkRunning()) b->launch_mythread();
+        flushPending();
+        for(auto b: branches) b->add_signal(sig);
+        if(sig >= DATASTREAM_END) for(auto b: branches) b->finish_mythread(true);
+    }
+
+    bool threaded = false;  ///< whether to run each branch in its own thread
+    size_t nbatch = 256;    ///< maximum single items grouped into a shared batch
 
 protected:
-    vector<dsink_t*> sinks; ///< output sinks
+    /// Threaded branch, passing shared batches to one output sink
+    class Branch: public SignalBufferWorker<batch_t> {
+    public:
+        typedef SignalBufferWorker<batch_t> SBW;
+
+        /// Constructor
+        Branch(dsink_t& s, int i): sink(s) { this->worker_id = i; }
+
+        /// queue signal at current position in stream
+        void add_signal(datastream_signal_t sig) {
+            if(!this->checkRunning()) sink.signal(sig);
+            else SBW::queue_signal(sig);
+        }
+
+    protected:
+        dsink_t& sink;              ///< output sink
+        vector<mutsink_t> scratch;  ///< private copy of batch, for mutable-item sinks
+
+        /// pass shared batch to sink
+        void process_item(batch_t& b) override { pushShared(b); }
+        /// pass signal to sink
+        void process_signal(datastream_signal_t sig) override { sink.signal(sig); }
+
+        /// pass shared batch to sink: immutable items viewed directly
+        template<typename U = T>
+        typename std::enable_if<std::is_const<U>::value>::type pushShared(const batch_t& b) { sink.push_batch(*b); }
+        /// pass shared batch to sink: mutable items copied for this branch
+        template<typename U = T>
+        typename std::enable_if<!std::is_const<U>::value>::type pushShared(const batch_t& b) {
+            scratch.assign(b->begin(), b->end());
+            sink.push_batch(scratch);
+            scratch.clear();
+        }
+    };
+
+    /// whether branch threads are accepting input
+    bool running() const { return threaded && branches.size() && branches[0]->checkRunning(); }
+
+    /// send pending items to all branches as one shared batch
+    void flushPending() {
+        if(!pending.size()) return;
+        batch_t b = std::make_shared<const vector<mutsink_t>>(std::move(pending));
+        pending.clear();
+        for(auto br: branches) br->add_item(b);
+    }
+
+    /// apply queue settings to branch
+    static void configureBranch(SettingsQuery& Cfg, Branch& B) {
+        int n = 0;
+        if(Cfg.lookupValue("capacity", n, "maximum queued batches (0 for unlimited)")) B.capacity = std::max(n, 0);
+        Cfg.lookupEnum("overflow", B.overflow, "policy for input at capacity",
+                       {{"block", Branch::OVERFLOW_BLOCK}, {"drop_oldest", Branch::OVERFLOW_DROP_OLDEST}, {"drop_newest", Branch::OVERFLOW_DROP_NEWEST}});
+        if(Cfg.lookupValue("high_water", n, "queued batches signalling upstream backpressure")) {
+            B.high_water = std::max(n, 0);
+            B.low_water = B.high_water / 2;
+        }
+        if(Cfg.lookupValue("low_water", n, "queued batches releasing upstream backpressure")) B.low_water = std::max(n, 0);
+        string s;
+        if(Cfg.lookupValue("backpressure", s, "named gate throttling upstream sources while above high_water"))
+            B.watermark_cb = BackpressureGate::named(s).listener();
+    }
+
+    /// copy queue settings between branches
+    static void copyQueueSettings(const Branch& from, Branch& to) {
+        to.capacity = from.capacity;
+        to.overflow = from.overflow;
+        to.high_water = from.high_water;
+        to.low_water = from.low_water;
+        to.watermark_cb = from.watermark_cb;
+    }
+
+    vector<dsink_t*> sinks;     ///< output sinks
+    vector<Branch*> branches;   ///< threaded-mode branch workers
+    vector<mutsink_t> pending;  ///< items collected for next shared batch
 };
 
 #endif
@@ -5,18 +5,45 @@
 #define DATASOURCE_HH
 
 #include <limits>
+#include <algorithm>
 #include <vector>
 using std::vector;
+#include <string>
+using std::string;
+#include <future>
+#include <fcntl.h>
+#include <unistd.h>
+#include "span_view.hh"
+#include "DataSink.hh"
+#include "Checkpoint.hh"
 
 /// Reader from a file
 class _FileSource {
 public:
     virtual void openInput(const string& f) { infile_name = f; }
+    /// set input file to open later, with openDeferred() (e.g. from a prefetch thread)
+    void deferInput(const string& f) { deferred_name = f; }
+    /// open deferred input file, if any
+    void openDeferred() {
+        if(!deferred_name.size()) return;
+        string f;
+        std::swap(f, deferred_name);
+        openInput(f);
+    }
+    /// request OS readahead of deferred input file, without library calls (safe alongside reads of other files)
+    void readahead() const {
+        if(!deferred_name.size()) return;
+        int fd = open(deferred_name.c_str(), O_RDONLY);
+        if(fd < 0) return;
+        posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+        close(fd);
+    }
     string infile_name;     ///< input filename
+    string deferred_name;   ///< input filename awaiting openDeferred()
 };
 
-/// Type-independent DataSource base class
-class _DataSource {
+/// Type-independent DataSource base class; checkpoint state is the read position
+class _DataSource: public Checkpointable {
 public:
     /// maximum "infinite" entries
     static constexpr size_t max_entries = std::numeric_limits<size_t>::max();
@@ -26,6 +53,8 @@ public:
 
     /// Initialize for read start
     virtual void init_dsource() { }
+    /// Hint to prepare for reading (open deferred input, load metadata, start read-ahead); may be called from another thread
+    virtual void prefetch() { }
     /// Reset to start
     virtual void reset() { nread = 0; id_current_evt = -1; }
     /// Skip ahead n items
@@ -40,6 +69,15 @@ public:
     /// get number of rows already read
     size_t getNRead() const { return nread; }
 
+    /// save read position
+    void saveState(BinaryWriter& B) const override { B.send(nread); }
+    /// restore read position, skipping ahead from start
+    void restoreState(BinaryReader& B) override {
+        auto n = B.receive<size_t>();
+        reset();
+        if(n && !skip(n)) throw std::runtime_error("Checkpoint read position beyond end of input");
+    }
+
     bool doLoop = false;    /// whether to do infinite looping
     int nLoad = -1;         ///< entries loading limit; set >= 0 to apply
 
@@ -57,6 +95,13 @@ public:
 
     /// Fill supplied item with next object; return whether item has been updated
     virtual bool next(val_t&) = 0;
+    /// View of next (up to nmax) objects, valid until next read; empty at end of data
+    virtual span_view<val_t> next_batch(size_t nmax) {
+        batchbuf.resize(nmax);
+        size_t n = 0;
+        while(n < nmax && next(batchbuf[n])) ++n;
+        return span_view<val_t>(batchbuf.data(), n);
+    }
     /// Skip ahead n items
     bool skip(size_t n) override { val_t x; while(n--) if(!next(x)) return false; return true; }
     /// pop with infinite looping
@@ -65,8 +110,32 @@ public:
     bool next_optloop(val_t& o) { return doLoop? next_loop(o) : next(o); }
     /// get identifying number for value type
     static int64_t getIdentifier(const val_t& i) { return i.evt; }
+
+protected:
+    vector<val_t> batchbuf; ///< buffer for default next_batch implementation
 };
 
+/// Feed up to nmax items from source into sink, one push_batch() per source batch (e.g. per HDF5 chunk); return number of items fed.
+/// Follows source doLoop. Datastream signals (INIT, END, ...) are left to the caller.
+template<class C, typename T>
+size_t pumpSource(DataSource<C>& src, DataSink<T>& snk, size_t nmax = _DataSource::max_entries, size_t nbatch = 1024) {
+    size_t n = 0;
+    bool looped = false;    // whether a reset has read nothing yet (no infinite loop on empty source)
+    while(n < nmax) {
+        auto b = src.next_batch(std::min(nbatch, nmax - n));
+        if(b.empty()) {
+            if(!src.doLoop || looped) break;
+            src.reset();
+            looped = true;
+            continue;
+        }
+        looped = false;
+        snk.push_batch(b);
+        n += b.size();
+    }
+    return n;
+}
+
 /// Sequence of DS ~ DataSource
 template<class DS>
 class DataSourceSeq: public DS {
@@ -84,18 +153,49 @@ public:
 
     /// Fill o with next object; return whether o updated
     bool next(val_t& o) override {
-        while(i < v.size() && !v[i]->next(o)) { nextSource(); ++i; }
-        return i < v.size();
+        if(!started) start();
+        while(i < v.size() && !v[i]->next(o)) advance();
+        if(i == v.size()) return false;
+        ++this->nread;
+        return true;
+    }
+
+    /// View of next batch of objects, from current underlying source
+    span_view<val_t> next_batch(size_t nmax) override {
+        if(!started) start();
+        while(i < v.size()) {
+            auto b = v[i]->next_batch(nmax);
+            this->nread += b.size();
+            if(b.size()) return b;
+            advance();
+        }
+        return {};
     }
 
     /// Reset to start
-    void reset() override { while(i) v[--i]->reset(); }
+    void reset() override {
+        if(pending.valid()) pending.get();
+        if(i < v.size()) v[i]->reset(); // partially-read current source
+        while(i) v[--i]->reset();
+        started = false;
+        _DataSource::reset();
+    }
 
-    /// Estimate remaining data size (no loop)
+    /// Skip ahead n items, across sources
+    bool skip(size_t n) override {
+        while(n) {
+            auto b = next_batch(n);
+            if(!b.size()) return false;
+            n -= b.size();
+        }
+        return true;
+    }
+
+    /// Estimate total data size (no loop), summed over sources
     size_t entries() const override {
         size_t e = 0;
-        for(auto j = i; j < v.size(); ++j) {
-            auto ee = v[j]->entries();
+        for(auto j: v) {
+            auto ee = j->entries();
             if(ee == dsrc_t::max_entries) return dsrc_t::max_entries;
             e += ee;
         }
@@ -103,12 +203,39 @@ public:
     }
 
 
+    /// prefetch() each upcoming source in background while the current one drains (sources must tolerate concurrent use)
+    bool prefetchNext = false;
+
 protected:
     /// Called when switching to next source
     virtual void nextSource() { }
 
-    vector<dsrc_t*> v;  ///< underlying sources
-    size_t i = 0;       ///< current position in sources list
+    /// begin reading first source
+    void start() {
+        started = true;
+        if(prefetchNext && v.size()) v[0]->prefetch();
+        prefetch_following();
+    }
+
+    /// move to next source, completing its prefetch
+    void advance() {
+        nextSource();
+        ++i;
+        if(pending.valid()) pending.get();  // re-throws any exception from prefetch
+        prefetch_following();
+    }
+
+    /// start background prefetch of source after current
+    void prefetch_following() {
+        if(!prefetchNext || i + 1 >= v.size()) return;
+        auto s = v[i + 1];
+        pending = std::async(std::launch::async, [s] { s->prefetch(); });
+    }
+
+    vector<dsrc_t*> v;          ///< underlying sources
+    size_t i = 0;               ///< current position in sources list
+    bool started = false;       ///< whether reading (and prefetching) has started
+    std::future<void> pending;  ///< background prefetch of source i + 1
 };
 
 #endif
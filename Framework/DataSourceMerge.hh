@@ -0,0 +1,112 @@
+/// @file DataSourceMerge.hh Time-ordered merge of multiple DataSources, each read in its own thread
+
+#ifndef DATASOURCEMERGE_HH
+#define DATASOURCEMERGE_HH
+
+#include "PrefetchingSource.hh"
+#include "LoserTree.hh"
+
+/// Merge of individually-ordered DS ~ DataSource streams into one ordered stream.
+/// Each stream is read ahead (decoded) by its own PrefetchingSource thread; a loser tree on the
+/// stream heads selects the next item in log2(N) comparisons.
+/// nLoad limits the total merged items; doLoop (next_optloop) re-starts all streams together.
+/// Streams are read concurrently, so must not share unsynchronized state (HDF5_Table_Cache reads serialize on HDF5_mutex()).
+template<class DS, typename _ordering_t = typename DS::val_t::ordering_t>
+class DataSourceMerge: public DS {
+public:
+    /// Underlying datasource type
+    typedef DS dsrc_t;
+    /// Underlying data type
+    typedef typename dsrc_t::val_t val_t;
+    /// ordering type
+    typedef _ordering_t ordering_t;
+
+    /// Constructor inheritance
+    using dsrc_t::dsrc_t;
+
+    /// Destructor
+    ~DataSourceMerge() { for(auto p: v) delete p; }
+
+    /// Add stream (not owned), to be read in its own thread concurrently with other streams
+    virtual void addStream(dsrc_t& S) {
+        v.push_back(new PrefetchingSource<dsrc_t>(S, nbatch, nqueue));
+        started = false;
+    }
+
+    /// Fill o with next object in merged order; return whether o updated
+    bool next(val_t& o) override {
+        if(!started) start();
+        if(LT.empty() || (this->nLoad >= 0 && this->nread >= size_t(this->nLoad))) return false;
+
+        auto w = LT.winner();
+        o = std::move(head[w]);
+        if(v[w]->next(head[w])) LT.update(w, ordering_t(head[w]));
+        else LT.update_done(w);
+
+        auto x = ordering_t(o);
+        if(this->nread && x < x_prev) ++n_disordered;
+        x_prev = x;
+        ++this->nread;
+        return true;
+    }
+
+    /// View of next (up to nmax) objects in merged order, valid until next read
+    span_view<val_t> next_batch(size_t nmax) override {
+        mergebuf.resize(nmax);
+        size_t n = 0;
+        while(n < nmax && next(mergebuf[n])) ++n;
+        return span_view<val_t>(mergebuf.data(), n);
+    }
+
+    /// Re-start all streams at beginning
+    void reset() override {
+        for(auto p: v) p->reset();
+        started = false;
+        _DataSource::reset();
+    }
+
+    /// Skip ahead n items (in merged order)
+    bool skip(size_t n) override {
+        val_t x;
+        while(n--) if(!next(x)) return false;
+        return true;
+    }
+
+    /// Estimate total data size (no loop), summed over streams
+    size_t entries() const override {
+        size_t e = 0;
+        for(auto p: v) {
+            auto ee = p->entries();
+            if(ee == dsrc_t::max_entries) return dsrc_t::max_entries;
+            e += ee;
+        }
+        return e;
+    }
+
+    /// start read-ahead on all streams
+    void prefetch() override { for(auto p: v) p->prefetch(); }
+
+    size_t nbatch = 1024;       ///< read-ahead batch size for streams added after setting
+    size_t nqueue = 4;          ///< read-ahead batches queued per stream, for streams added after setting
+    size_t n_disordered = 0;    ///< number of items output before previous item (disordered input streams)
+
+protected:
+    /// load first item of each stream into merge tree
+    void start() {
+        started = true;
+        for(auto p: v) p->prefetch(); // start all threads before waiting on any
+        head.resize(v.size());
+        LT.resize(v.size());
+        for(size_t i = 0; i < v.size(); ++i) if(v[i]->next(head[i])) LT.set(i, ordering_t(head[i]));
+        LT.build();
+    }
+
+    vector<PrefetchingSource<dsrc_t>*> v;   ///< read-ahead wrappers on underlying streams
+    vector<val_t> head;                     ///< current (next to output) item from each stream
+    vector<val_t> mergebuf;                 ///< buffer for next_batch
+    LoserTree<ordering_t> LT;               ///< merge tree on stream heads
+    bool started = false;                   ///< whether stream heads are loaded
+    ordering_t x_prev{};                    ///< previous output ordering
+};
+
+#endif
@@ -0,0 +1,167 @@
+/// @file JobGraph.hh Dependency graph of jobs with typed futures, run on JobQueue-type executors
+
+#ifndef JOBGRAPH_HH
+#define JOBGRAPH_HH
+
+#include "JobQueue.hh"
+#include "StealingJobQueue.hh"
+#include <atomic>
+#include <functional>
+#include <future>
+#include <initializer_list>
+#include <mutex>
+#include <condition_variable>
+
+/// Job node in dependency graph; released to executor when all predecessors have completed
+class DAGJob: public JobQueue::Job {
+public:
+    /// Constructor, for queue category qn
+    explicit DAGJob(int n = 0): Job(n) { }
+
+    /// run job, then release successors
+    void run() final {
+        execute();
+        vector<DAGJob*> succ;
+        {
+            std::lock_guard<std::mutex> lk(succLock);
+            done = true;
+            std::swap(succ, successors);
+        }
+        for(auto s: succ) s->predDone();
+        auto cb = std::move(onDone); // job may be deleted during callback
+        if(cb) cb();
+    }
+
+    /// add predecessor (before submitting); no effect if already completed
+    void after(DAGJob& P) {
+        if(&P == this) return;
+        std::lock_guard<std::mutex> lk(P.succLock);
+        if(P.done) return;
+        ++npred;
+        P.successors.push_back(this);
+    }
+
+    /// submit to executor, once all predecessors (added before this call) complete
+    void submit(std::function<void(Job*)> addFn) {
+        add = std::move(addFn);
+        predDone(); // release construction hold
+    }
+
+    std::function<void()> onDone;   ///< completion callback (after successors released)
+
+protected:
+    /// perform job work (subclass me!)
+    virtual void execute() = 0;
+
+    /// one predecessor completed
+    void predDone() { if(!--npred) add(this); }
+
+    std::atomic<int> npred{1};      ///< outstanding predecessors, plus one hold until submit()
+    std::mutex succLock;            ///< lock on successors and done
+    vector<DAGJob*> successors;     ///< jobs waiting on this one
+    bool done = false;              ///< whether execute() has completed
+    std::function<void(Job*)> add;  ///< submit to executor
+};
+
+/// DAG job evaluating function with typed future result
+template<typename R>
+class FutureJob: public DAGJob {
+public:
+    /// Constructor
+    FutureJob(int n, std::function<R()> _f): DAGJob(n), f(std::move(_f)), fut(prom.get_future().share()) { }
+
+    /// result future, ready once job completes
+    const std::shared_future<R>& future() const { return fut; }
+    /// get result (blocks until complete; rethrows any exception from job)
+    decltype(std::declval<const std::shared_future<R>&>().get()) get() const { return fut.get(); }
+
+protected:
+    /// evaluate function into promise
+    void execute() override {
+        try { set_result<R>(); }
+        catch(...) { prom.set_exception(std::current_exception()); }
+    }
+    /// store non-void result
+    template<typename U>
+    typename std::enable_if<!std::is_void<U>::value>::type set_result() { prom.set_value(f()); }
+    /// void result
+    template<typename U>
+    typename std::enable_if<std::is_void<U>::value>::type set_result() { f(); prom.set_value(); }
+
+    std::function<R()> f;           ///< function to evaluate
+    std::promise<R> prom;           ///< result promise
+    std::shared_future<R> fut;      ///< result future
+};
+
+/// Dependency graph of jobs, each released onto the executor as soon as its inputs are complete
+/// (instead of phase-by-phase flush() barriers). Released jobs go through the executor's usual add(),
+/// so per-queue-category max_workers limits apply.
+template<class JQ_t = StealingJobQueue>
+class JobGraph {
+public:
+    /// Constructor, submitting to executor
+    explicit JobGraph(JQ_t& q): JQ(q) { }
+    /// Destructor: wait for completion and clean up
+    ~JobGraph() {
+        wait();
+        for(auto j: jobs) delete j;
+    }
+    /// no copying
+    JobGraph(const JobGraph&) = delete;
+    /// no assignment
+    JobGraph& operator=(const JobGraph&) = delete;
+
+    /// add function job on queue category qn, running after listed (non-null) predecessors; returns job, for its future or as dependency
+    template<typename F, typename R = decltype(std::declval<F>()())>
+    FutureJob<R>& add(int qn, F f, std::initializer_list<DAGJob*> preds = {}) {
+        return add(qn, std::move(f), preds.begin(), preds.end());
+    }
+
+    /// add function job after predecessors in range [p0, p1)
+    template<typename F, typename It, typename R = decltype(std::declval<F>()())>
+    FutureJob<R>& add(int qn, F f, It p0, It p1) {
+        auto J = new FutureJob<R>(qn, std::move(f));
+        for(auto it = p0; it != p1; ++it) if(*it) J->after(**it);
+        submit(J);
+        return *J;
+    }
+
+    /// add externally-constructed job (graph assumes ownership), after listed predecessors
+    DAGJob& add(DAGJob* J, std::initializer_list<DAGJob*> preds = {}) {
+        for(auto P: preds) if(P) J->after(*P);
+        submit(J);
+        return *J;
+    }
+
+    /// wait for all jobs added so far to complete
+    void wait() {
+        std::unique_lock<std::mutex> lk(doneLock);
+        allDone.wait(lk, [this] { return !n_incomplete; });
+    }
+
+    /// number of jobs not yet completed
+    size_t incomplete() const { return n_incomplete.load(); }
+
+protected:
+    /// take ownership and submit job
+    void submit(DAGJob* J) {
+        {
+            std::lock_guard<std::mutex> lk(doneLock);
+            jobs.push_back(J);
+            ++n_incomplete;
+        }
+        J->onDone = [this] {
+            std::lock_guard<std::mutex> lk(doneLock);
+            if(!--n_incomplete) allDone.notify_all();
+        };
+        J->submit([this](JobQueue::Job* j) { JQ.add(j); });
+    }
+
+    JQ_t& JQ;                               ///< executor
+    vector<DAGJob*> jobs;                   ///< owned jobs
+    std::mutex doneLock;                    ///< lock on jobs list and completion notification
+    std::condition_variable allDone;        ///< completion notification
+    std::atomic<size_t> n_incomplete{0};    ///< number of incomplete jobs
+};
+
+#endif
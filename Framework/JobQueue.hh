@@ -20,7 +20,7 @@ using std::map;
 class JobQueue: private boost::noncopyable {
 public:
     /// Destructor
-    virtual ~JobQueue() { assert(!halt); }
+    virtual ~JobQueue() { assert(halt); }
 
     /// Base class defining a job to run
     class Job {
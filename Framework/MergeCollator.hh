@@ -0,0 +1,279 @@
+/// @file MergeCollator.hh Combine ordered items from multiple threads via per-input queues and loser-tree merge
+
+#ifndef MERGECOLLATOR_HH
+#define MERGECOLLATOR_HH
+
+#include "_Collator.hh"
+#include "SinkUser.hh"
+#include "SPSCRing.hh"
+#include "LoserTree.hh"
+#include "deref_if_ptr.hh"
+#include "TermColor.hh"
+
+#include <atomic>
+#include <chrono>
+
+/// Combine ordered items received from multiple threads
+/// Each input thread pushes into its own lock-free SPSC queue; one merge thread selects the lowest-ordered
+/// queue head with a loser tree, blocking only while a (not-ended) input has no data available.
+/// Inputs end on DATASTREAM_END, or when the merge thread is finished.
+/// Required-item thresholds (change_required, etc.) are latched when the merge thread is launched.
+template<typename T, typename _ordering_t = typename std::remove_pointer<T>::type::ordering_t>
+class MergeCollator: virtual public _Collator, public SinkUser<const T> {
+public:
+    typedef _ordering_t ordering_t;
+    typedef typename std::remove_const<T>::type Tmut_t;
+    using SinkUser<const T>::nextSink;
+
+    /// Destructor
+    ~MergeCollator() {
+        if(checkRunning()) finish_mythread();
+        size_t nleft = 0;
+        for(auto i: vInputs) nleft += i->q.size();
+        if(nleft) printf("Warning: %zu items left in un-flushed collator queues\n", nleft);
+        for(auto i: vInputs) delete i;
+    }
+
+    /// input handle for one producer thread
+    class MInput: public DataSink<T> {
+    public:
+        /// constructor
+        MInput(MergeCollator& M, _SinkUser* s, size_t nq): inSrc(s), n(M.add_input()), q(nq) {
+            if(inSrc) {
+                inSrc->_setNext(this);
+                inSrc->setOwnsNext(false);
+            }
+        }
+        /// DataSink push
+        void push(T& o) override { q.emplace(o); }
+        /// DataSink batch push
+        void push_batch(typename DataSink<T>::span_t v) override { for(auto& o: v) q.emplace(o); }
+        /// end of input on DATASTREAM_END; other signals ignored
+        void signal(datastream_signal_t s) override {
+            if(s == DATASTREAM_END) q.close();
+            else if(s == DATASTREAM_INIT || s == DATASTREAM_REINIT) q.reopen();
+        }
+
+        _SinkUser* inSrc = nullptr; ///< input to this collator slot
+        const size_t n;             ///< input enumeration
+        SPSCRing<Tmut_t> q;         ///< input queue
+    };
+
+    /// add new input (optionally connected to SinkUser)
+    MInput& new_input(_SinkUser* s = nullptr, int nreq = 0) {
+        vInputs.push_back(new MInput(*this, s, queue_size));
+        if(nreq) change_required(vInputs.back()->n, nreq);
+        return *vInputs.back();
+    }
+
+    /// connect SinkUser as input
+    void connect_input(_SinkUser& s, int nreq = 0) override { new_input(&s, nreq); }
+
+    /// handle signals: flush-type signals output everything currently queued; passed downstream in order with data
+    void signal(datastream_signal_t sig) override {
+        unique_lock<mutex> lk(sigMut);
+        if(!merging) {
+            process_signal(sig);
+            return;
+        }
+        sigDone.wait(lk, [this] { return !sigPending.load(); });
+        pendingSig = sig;
+        sigPending = true;
+        for(auto i: vInputs) i->q.wake_consumer();
+        sigWake.notify_all();
+        sigDone.wait(lk, [this] { return !sigPending.load(); });
+    }
+
+    /// launch merge thread
+    void launch_mythread() override {
+        req.resize(vInputs.size());
+        for(size_t i = 0; i < req.size(); ++i) req[i] = get_required(i);
+        stop_merge = false;
+        Threadworker::launch_mythread();
+    }
+
+    /// end all inputs; finish merging queued items and stop thread
+    void finish_mythread(bool unlaunched_OK = false) override {
+        if(checkRunning()) {
+            for(auto i: vInputs) i->q.close();
+            {
+                lock_guard<mutex> lk(sigMut);
+                stop_merge = true;
+                sigWake.notify_all();
+            }
+        }
+        Threadworker::finish_mythread(unlaunched_OK);
+    }
+
+    vector<MInput*> vInputs;    ///< input adapters
+    size_t queue_size = 4096;   ///< capacity of per-input queues (for inputs added after setting)
+
+protected:
+    /// input availability states
+    enum input_state_t {
+        INPUT_READY,    ///< next item available
+        INPUT_DONE,     ///< ended and empty
+        INPUT_IDLE,     ///< empty, but not required (re-checked each item)
+        INPUT_BLOCKED   ///< must wait for more data
+    };
+
+    LoserTree<ordering_t> LT;   ///< merge tree on input queue heads
+    vector<int> req;            ///< latched required thresholds
+    vector<size_t> idle;        ///< inputs in INPUT_IDLE state
+
+    mutex sigMut;                           ///< lock on signal hand-off
+    std::condition_variable sigWake;        ///< wake idle merge thread
+    std::condition_variable sigDone;        ///< signal processing complete
+    std::atomic<bool> sigPending{false};    ///< signal waiting for merge thread
+    datastream_signal_t pendingSig = DATASTREAM_NOOP;  ///< signal to process
+    bool merging = false;                   ///< whether merge thread is active (protected by sigMut)
+    std::atomic<bool> stop_merge{false};    ///< request to stop when inputs are drained
+
+    /// check whether stop requested
+    bool stopping() const { return stop_merge || runstat == STOP_REQUESTED; }
+
+    /// evaluate input status
+    input_state_t settle(size_t i) {
+        auto& q = vInputs[i]->q;
+        auto p = q.front();
+        bool ended = q.is_closed() || stopping();
+        if(!p) {
+            if(ended) return (p = q.front())? INPUT_READY : INPUT_DONE;   // catch data arriving before close
+            return req[i] < 0? INPUT_IDLE : INPUT_BLOCKED;
+        }
+        if(ended || req[i] <= 0 || q.size() > size_t(req[i])) return INPUT_READY;
+        return INPUT_BLOCKED;
+    }
+
+    /// ordering of input queue head
+    ordering_t head_order(size_t i) { return ordering_t(deref_if_ptr(*vInputs[i]->q.front())); }
+
+    /// wait for input to leave INPUT_BLOCKED state; may return INPUT_BLOCKED if interrupted by signal or stop
+    input_state_t await_input(size_t i) {
+        while(true) {
+            auto st = settle(i);
+            if(st != INPUT_BLOCKED || sigPending || stopping()) return st;
+            if(vInputs[i]->q.front()) sched_yield();    // waiting on more than one item
+            else vInputs[i]->q.wait_front(10000);       // periodic wakeup to catch pause requests
+            if(runstat == PAUSE_REQUESTED) check_pause();
+        }
+    }
+
+    /// place input in merge tree according to state (without replay)
+    void set_input(size_t i, input_state_t st) {
+        if(st == INPUT_READY) LT.set(i, head_order(i));
+        else {
+            LT.set_done(i);
+            if(st == INPUT_IDLE) idle.push_back(i);
+        }
+    }
+
+    /// (re)build merge tree from all inputs; return false if interrupted while waiting
+    bool build_tree() {
+        idle.clear();
+        for(size_t i = 0; i < vInputs.size(); ++i) {
+            auto st = await_input(i);
+            if(st == INPUT_BLOCKED) return false;
+            set_input(i, st);
+        }
+        LT.build();
+        return true;
+    }
+
+    /// output all currently-queued items, in order
+    void drain() {
+        LoserTree<ordering_t> D(vInputs.size());
+        for(size_t i = 0; i < vInputs.size(); ++i) if(vInputs[i]->q.front()) D.set(i, head_order(i));
+        D.build();
+        while(!D.empty()) {
+            auto w = D.winner();
+            auto& q = vInputs[w]->q;
+            if(nextSink) nextSink->push(*q.front());
+            q.pop();
+            if(q.front()) D.update(w, head_order(w));
+            else D.update_done(w);
+        }
+    }
+
+    /// process signal (in merge thread, or when merge thread inactive)
+    void process_signal(datastream_signal_t sig) {
+        if(sig >= DATASTREAM_FLUSH) drain();
+        if(nextSink) nextSink->signal(sig);
+    }
+
+    /// process signal posted to merge thread
+    void handle_pending() {
+        lock_guard<mutex> lk(sigMut);
+        process_signal(pendingSig);
+        sigPending = false;
+        sigDone.notify_all();
+    }
+
+    /// merge thread
+    void threadjob() override {
+        {
+            lock_guard<mutex> lk(sigMut);
+            merging = true;
+        }
+        LT.resize(vInputs.size());
+
+        bool stale = true;  // whether merge tree needs rebuilding
+        while(true) {
+            if(sigPending) {
+                handle_pending();
+                stale = true;
+            }
+            if(runstat == PAUSE_REQUESTED) check_pause();
+
+            if(stale) {
+                if(!build_tree()) continue;
+                stale = false;
+            }
+
+            // check for new arrivals on idle (non-required) inputs
+            for(auto i: idle) if(vInputs[i]->q.front()) stale = true;
+            if(stale) continue;
+
+            if(LT.empty()) { // nothing available
+                if(stopping() && idle.empty()) break;
+                unique_lock<mutex> lk(sigMut);
+                sigWake.wait_for(lk, std::chrono::milliseconds(1), [this] { return sigPending || stop_merge; });
+                stale = true;
+                continue;
+            }
+
+            auto w = LT.winner();
+            auto& q = vInputs[w]->q;
+            if(nextSink) nextSink->push(*q.front());
+            q.pop();
+
+            auto st = settle(w);
+            if(st == INPUT_BLOCKED) st = await_input(w);
+            if(st == INPUT_BLOCKED) stale = true;
+            else if(st == INPUT_READY) LT.update(w, head_order(w));
+            else {
+                LT.update_done(w);
+                if(st == INPUT_IDLE) idle.push_back(w);
+            }
+        }
+
+        {
+            lock_guard<mutex> lk(sigMut);
+            merging = false;
+            if(sigPending) {
+                process_signal(pendingSig);
+                sigPending = false;
+                sigDone.notify_all();
+            }
+        }
+        if(nextSink) nextSink->signal(DATASTREAM_FLUSH);
+
+        if(verbose > 3) {
+            size_t nw = 0;
+            for(auto i: vInputs) nw += i->q.n_full_waits;
+            printf(TERMFG_BLUE "  MergeCollator [%i] done (%zu full-queue waits)." TERMSGR_RESET "\n", worker_id, nw);
+        }
+    }
+};
+
+#endif
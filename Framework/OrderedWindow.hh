@@ -15,6 +15,9 @@
 #include <stdexcept>
 #include <deque>
 using std::deque;
+#include "ring_deque.hh"
+#include "AllocPool.hh"
+#include "Checkpoint.hh"
 
 /// `for(auto& x: ItRange(start, end))`
 template<class iterator>
@@ -32,15 +35,17 @@ public:
 
 /// Flow-through analysis on a ``window'' of ordered objects
 /// input is always const T; inspection functions depend on const-ness of T
-template<class T, typename _ordering_t = typename std::remove_pointer<T>::type::ordering_t>
-class OrderedWindow: protected deque<typename std::remove_const<T>::type>, public DataSink<const T> {
+/// _container_t is the (std::deque-like) window storage, e.g. ring_deque for contiguous ring-buffer storage
+template<class T, typename _ordering_t = typename std::remove_pointer<T>::type::ordering_t,
+         class _container_t = deque<typename std::remove_const<T>::type>>
+class OrderedWindow: protected _container_t, public DataSink<const T>, public Checkpointable {
 public:
     /// internal mutable type
     typedef typename std::remove_const<T>::type Tmut_t;
     /// ordering type
     typedef _ordering_t ordering_t;
     /// internal queue type
-    typedef deque<Tmut_t> deque_t;
+    typedef _container_t deque_t;
     /// iterator type
     typedef typename deque_t::iterator iterator;
     /// iterator range
@@ -71,9 +76,9 @@ public:
     /// get window half-width
     ordering_t windowHalfwidth() const { return hwidth; }
 
-    /// clear remaining objects through window (at end of run, etc.)
+    /// clear remaining objects through window (at end of run, etc.), or save in checkpoint
     void signal(datastream_signal_t sig) override {
-        if(sig < DATASTREAM_FLUSH) return;
+        if(sig < DATASTREAM_FLUSH || (sig == DATASTREAM_CHECKPT && this->takeCheckpoint())) return;
         if(size()) {
             window_Hi = order(back());
             window_Lo = window_Hi - 2*hwidth;
@@ -103,7 +108,7 @@ public:
     /// get current middle element
     const T& getMid() const { return this->at(imid); }
     /// get ordering position of middle object
-    ordering_t xMid() const { if(!size()) return {}; return order(this->at(imid)); }
+    ordering_t xMid() const { if(!size()) return {}; return order((*this)[imid]); }
 
     /// print window information
     virtual void display() const {
@@ -121,16 +126,16 @@ public:
     int nProcessed = 0; ///< number of objects processed through window
 
     /// get iterator to first item in window with order >= x
-    iterator abs_position(ordering_t x) { return std::lower_bound(begin(), end(), x, [](const T& a, ordering_t t) { return order(a) < t; }); }
+    iterator abs_position(ordering_t x) { return begin() + position_index(x, imid); }
     /// get const_iterator to first item in window with order >= x
-    const_iterator abs_position(ordering_t x) const { return std::lower_bound(begin(), end(), x, [](const T& a, ordering_t t) { return order(a) < t; }); }
+    const_iterator abs_position(ordering_t x) const { return begin() + position_index(x, imid); }
     /// check if item is in available range
     bool in_range(ordering_t x) const { return window_Lo < x && x < window_Hi; }
 
     /// get iterator to first item in window with order >= xMid + dx
-    iterator rel_position(ordering_t dx) { return abs_position(xMid()+dx); }
-    /// get const_iterator to first item in window with order >= xMid + dx
-    const_iterator rel_position(ordering_t dx) const { return abs_position(xMid()+dx); }
+    iterator rel_position(ordering_t dx) { return begin() + rel_index(dx); }
+    /// get const_iterator to first item in window with order >= xMid + dx (searched from mid, without updating cursors: safe for concurrent const readers)
+    const_iterator rel_position(ordering_t dx) const { return begin() + position_index(xMid() + dx, imid); }
 
     /// get window position range for range offset from mid --- no bounds check
     itrange_t _rel_range(ordering_t dx0, ordering_t dx1) { return {rel_position(dx0), rel_position(dx1)}; }
@@ -156,10 +161,14 @@ public:
     size_t rel_count(ordering_t dx0, ordering_t dx1) const { return rel_range(dx0,dx1).size(); }
 
     bool enforceClear = true;                       ///< fail if window not clear on destruction
+    bool recycleOld = false;                        ///< return objects leaving window to RecyclePool (for re-use of their allocated storage)
     bool enforceBounds = false;                     ///< local paranoid bounds checking
 
     /// get window position range for absolute range (no bounds checking)
-    itrange_t _abs_range(ordering_t x0, ordering_t x1) { return {abs_position(x0), abs_position(x1)}; }
+    itrange_t _abs_range(ordering_t x0, ordering_t x1) {
+        auto i0 = position_index(x0, imid);
+        return {begin() + i0, begin() + position_index(x1, i0)};
+    }
     /// get window position range for absolute range
     itrange_t abs_range(ordering_t x0, ordering_t x1) {
         if(!(x0 <= x1)) throw std::runtime_error("Invalid reverse-order abs_range requested");
@@ -169,7 +178,10 @@ public:
     }
 
     /// get (const) window position range for absolute range
-    const_itrange_t _abs_range(ordering_t x0, ordering_t x1) const { return {abs_position(x0), abs_position(x1)}; }
+    const_itrange_t _abs_range(ordering_t x0, ordering_t x1) const {
+        auto i0 = position_index(x0, imid);
+        return {begin() + i0, begin() + position_index(x1, i0)};
+    }
     /// get (const) window position range for absolute range
     const_itrange_t abs_range(ordering_t x0, ordering_t x1) const {
         if(!(x0 <= x1)) throw std::runtime_error("Invalid reverse-order abs_range requested");
@@ -181,26 +193,24 @@ public:
     /// count items in absolute range
     size_t abs_count(ordering_t dx0, ordering_t dx1) const { return abs_range(dx0,dx1).size(); }
 
-    /// add next newer object; process older as they pass through window.
-    void push(const T& o) override {
-        if(verbose >= 4) { printf("Adding new "); display(o); }
-
-        auto x = order(o);
-        if(!(x==x)) {
-            printf("*** NaN warning at item %i! Skipping!\n ***", nProcessed);
-            display(o);
-        } else if(hwidth && x < window_Lo && size()) {
-            processDisordered(o);
-        } else {
-            if(!hwidth) while(size()) nextmid();
-            else flushHi(x);
-            deque_t::push_back(o);
-            processNew(back());
-        }
-
-        ++nProcessed;
+    /// save window contents and position
+    void saveState(BinaryWriter& B) const override {
+        B << window_Lo << window_Hi << nProcessed << imid << npopped;
+        saveItems(B, begin(), end());
+    }
+    /// restore saved window contents, without re-processing
+    void restoreState(BinaryReader& B) override {
+        B >> window_Lo >> window_Hi >> nProcessed >> imid >> npopped;
+        deque_t::clear();
+        restoreItems<Tmut_t>(B, [this](Tmut_t&& o) { deque_t::push_back(std::move(o)); });
+        ncursors = 0;
     }
 
+    /// add next newer object; process older as they pass through window.
+    void push(const T& o) override { insert(o); }
+    /// add next newer object, taking (moving) its contents
+    void push_take(Tmut_t& o) { insert(std::move(o)); }
+
     ordering_t window_Lo = {};  ///< newest discarded (start of available range)
     ordering_t window_Hi = {};  ///< newest added/flushed (end of available range)
 
@@ -230,10 +240,54 @@ protected:
     virtual void display(const T& o) const { dispObj(o); }
 
     size_t imid = 0;    ///< index of "middle" object; always valid if size() > 0
+    size_t npopped = 0; ///< number of items removed from front (for absolute item numbering)
+
+    /// cached window position for rel_position(dx)
+    struct cursor_t {
+        ordering_t dx;  ///< offset from mid
+        size_t iabs;    ///< absolute item number (index + npopped) of last result
+    };
+    static constexpr size_t n_cursors = 8;  ///< number of cached rel_position cursors
+    cursor_t cursors[n_cursors];            ///< cached rel_position cursors (updated by non-const lookups only)
+    size_t ncursors = 0;                    ///< number of cursors in use
+    static constexpr size_t max_walk = 16;  ///< maximum incremental steps before falling back to binary search
+
+    /// index of first item with order >= x, walking from hint index (binary search if too far)
+    size_t position_index(ordering_t x, size_t i) const {
+        const size_t n = size();
+        if(i > n) i = n;
+        for(size_t k = 0; k < max_walk; ++k) {
+            if(i > 0 && !(order((*this)[i-1]) < x)) --i;
+            else if(i < n && order((*this)[i]) < x) ++i;
+            else return i;
+        }
+        auto cmp = [](const Tmut_t& a, ordering_t t) { return order(a) < t; };
+        if(i > 0 && !(order((*this)[i-1]) < x)) return std::lower_bound(begin(), begin() + i, x, cmp) - begin();
+        return std::lower_bound(begin() + i, end(), x, cmp) - begin();
+    }
+
+    /// index of first item with order >= xMid + dx, tracked incrementally for repeated dx
+    size_t rel_index(ordering_t dx) {
+        auto x = xMid() + dx;
+        cursor_t* c = cursors;
+        while(c < cursors + ncursors && c->dx != dx) ++c;
+        if(c == cursors + ncursors) {   // new cursor (replacing oldest if full), starting from mid
+            if(ncursors < n_cursors) ++ncursors;
+            else {
+                std::move(cursors + 1, cursors + n_cursors, cursors);
+                c = cursors + n_cursors - 1;
+            }
+            c->dx = dx;
+            c->iabs = imid + npopped;
+        }
+        auto i = position_index(x, c->iabs > npopped? c->iabs - npopped : 0);
+        c->iabs = i + npopped;
+        return i;
+    }
 
     /// analyze current "mid" object with processMid() and increment to next; flush if no next available
     void nextmid() {
-        processMid(this->at(imid));
+        processMid((*this)[imid]);
         window_Lo = order((*this)[imid]) - hwidth;
         ++imid;
 
@@ -242,12 +296,46 @@ protected:
         } else while(size()) disposeLo();
     }
 
+    /// add next newer object (copied or moved); process older as they pass through window.
+    template<typename U>
+    void insert(U&& o) {
+        if(verbose >= 4) { printf("Adding new "); display(o); }
+
+        auto x = order(o);
+        if(!(x==x)) {
+            printf("*** NaN warning at item %i! Skipping!\n ***", nProcessed);
+            display(o);
+        } else if(hwidth && x < window_Lo && size()) {
+            processDisordered(o);
+        } else {
+            if(!hwidth) while(size()) nextmid();
+            else flushHi(x);
+            deque_t::push_back(std::forward<U>(o));
+            processNew(back());
+        }
+
+        ++nProcessed;
+    }
+
+    /// return object to recycling pool, if poolable (has clear())
+    template<typename U>
+    static auto recycle(U& o, int) -> decltype(o.clear(), void()) { RecyclePool<U>::put(o); }
+    /// non-poolable object: no-op
+    template<typename U>
+    static void recycle(U&, long) { }
+
     /// delete oldest object off "older" queue; decrement imid to point to same item
     void disposeLo() {
         processOld(front());
+        if(recycleOld) recycle(front(), 0);
         pop_front();
+        ++npopped;
         --imid; // move imid to continue pointing to same object
     }
 };
 
+/// OrderedWindow with contiguous ring-buffer storage
+template<class T, typename _ordering_t = typename std::remove_pointer<T>::type::ordering_t>
+using RingOrderedWindow = OrderedWindow<T, _ordering_t, ring_deque<typename std::remove_const<T>::type>>;
+
 #endif
@@ -7,6 +7,9 @@
 #include "SinkUser.hh"
 #include "deref_if_ptr.hh"
 #include "SFINAEFuncs.hh" // for dispObj
+#include "CalendarQueue.hh"
+#include "StageStats.hh"
+#include "Checkpoint.hh"
 
 #include <queue>
 using std::priority_queue;
@@ -15,9 +18,11 @@ using std::priority_queue;
 #include <cmath> // for std::isfinite
 #include <csignal> // for SIGINT breakpoint
 
-/// Sort slightly-out-of-order items into proper order
-template<class T, typename _ordering_t = typename std::remove_pointer<T>::type::ordering_t>
-class OrderingQueue: public DataLink<const T, T> {
+/// Sort slightly-out-of-order items into proper order; _PQ_t selects priority queue engine (top() = lowest ordering)
+template<class T, typename _ordering_t = typename std::remove_pointer<T>::type::ordering_t,
+         class _PQ_t = priority_queue<typename std::remove_const<T>::type, vector<typename std::remove_const<T>::type>,
+                                      reverse_ordering_deref<typename std::remove_const<T>::type, _ordering_t>>>
+class OrderingQueue: public DataLink<const T, T>, public StageMetrics, public Checkpointable {
 public:
     /// input type
     using typename DataSink<const T>::sink_t;
@@ -28,7 +33,7 @@ public:
     /// mutable data
     using typename DataSink<sink_t>::mutsink_t;
     /// queue type
-    typedef priority_queue<mutsink_t, vector<mutsink_t>, reverse_ordering_deref<mutsink_t, ordering_t>> PQ_t;
+    typedef _PQ_t PQ_t;
 
     static constexpr ordering_t order_max = std::numeric_limits<ordering_t>::max();
 
@@ -53,9 +58,10 @@ public:
     template<typename U>
     static inline ordering_t order(U o) { return ordering_t(deref_if_ptr(o)); }
 
-    /// clear remaining objects through window
+    /// clear remaining objects through window (or save in checkpoint)
     void signal(datastream_signal_t sig) override {
-        if(sig >= DATASTREAM_FLUSH) {
+        bool saved = sig == DATASTREAM_CHECKPT && this->takeCheckpoint(); // keeps queue contents
+        if(sig >= DATASTREAM_FLUSH && !saved) {
             while(!PQ.empty()) {
                 auto o = PQ.top();
                 processOrdered(o);
@@ -68,6 +74,8 @@ public:
 
     /// flush events up to specified point
     void flushTo(ordering_t t) {
+        if(PQ.size() > max_queued) max_queued = PQ.size();
+        setWindow_imp(PQ, dt, 0);
         t0 = t;
         while(!PQ.empty()) {
             auto o = PQ.top();
@@ -80,6 +88,23 @@ public:
     /// add new item to sorted queue, with auto-flush
     void push(sink_t& o) override { push(o, true); }
 
+    /// add batch of items to sorted queue, flushing once at end
+    void push_batch(typename DataSink<const T>::span_t v) override {
+        ordering_t tf = t0;     // pending flush boundary, as if flushed after each item
+        for(auto& o: v) {
+            ordering_t t = order(o);
+            if(std::isfinite(t) && t >= tf) {
+                PQ.push(o);
+                tf = t - dt;
+            } else {    // unusual items: sync up queue state and use item-by-item handling
+                if(tf != t0) flushTo(tf);
+                push(o, true);
+                tf = t0;
+            }
+        }
+        if(tf != t0) flushTo(tf);
+    }
+
     /// add new item to sorted queue; optionally flush
     void push(sink_t& o, bool doFlush) {
 
@@ -95,6 +120,7 @@ public:
         }
 
         if(t < t0) {
+            ++n_disordered;
             printf("Warning: out-of-order queue event at %g < %g (%g)!\n",
                     double(t), double(t0), double(t0-t));
             dispObj(o);
@@ -123,12 +149,48 @@ public:
     ordering_t dt;              ///< flush ordered queue more than this far before highest item
     bool skip_disordered = true;    ///< skip over disordered events
     bool flush_disordered = true;   ///< flush queue on disordered entries
+    size_t n_disordered = 0;        ///< number of out-of-order items received
+    size_t max_queued = 0;          ///< queue size high-water mark
+
+    /// report queue statistics
+    void getStageMetrics(StageStats& S) const override {
+        S.queue_hwm = std::max(S.queue_hwm, max_queued);
+        S.n_disordered += n_disordered;
+    }
+
+    /// save queue contents (in output order) and flush boundary
+    void saveState(BinaryWriter& B) const override {
+        B << t0 << n_disordered << max_queued;
+        auto q = PQ;
+        B.send<size_t>(q.size());
+        while(!q.empty()) {
+            saveObj(B, q.top());
+            q.pop();
+        }
+    }
+    /// restore saved queue contents, replacing any current contents
+    void restoreState(BinaryReader& B) override {
+        PQ = PQ_t();
+        B >> t0 >> n_disordered >> max_queued;
+        restoreItems<mutsink_t>(B, [this](mutsink_t&& o) { PQ.push(o); });
+    }
 
 protected:
-    PQ_t PQ;
+    PQ_t PQ;    ///< ordering queue
+
+    /// called when Q::setWindow defined: inform queue engine of ordering window
+    template<class Q>
+    static auto setWindow_imp(Q& q, ordering_t w, int) -> decltype(q.setWindow(w), void()) { q.setWindow(w); }
+    /// default called when no Q::setWindow defined
+    template<class Q>
+    static void setWindow_imp(Q&, ordering_t, long) { }
 
     /// pass down chain
     virtual void processOrdered(output_t& o) { if(this->nextSink) this->nextSink->push(o); }
 };
 
+/// OrderingQueue using bucketed calendar queue: amortized O(1) per item, for large and/or dense queues
+template<class T, typename _ordering_t = typename std::remove_pointer<T>::type::ordering_t>
+using CalendarOrderingQueue = OrderingQueue<T, _ordering_t, CalendarQueue<typename std::remove_const<T>::type, _ordering_t>>;
+
 #endif
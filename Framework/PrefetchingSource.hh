@@ -0,0 +1,178 @@
+/// @file PrefetchingSource.hh Asynchronous read-ahead wrapper for DataSource<T>
+
+#ifndef PREFETCHINGSOURCE_HH
+#define PREFETCHINGSOURCE_HH
+
+#include "DataSource.hh"
+#include "Threadworker.hh"
+#include <deque>
+#include <exception>
+#include <utility>
+
+/// Runs underlying source's next_batch() in a background thread, into a bounded queue of batches.
+/// Reads, skip(), reset() and entries() from the consumer side see the same stream as the underlying source;
+/// the underlying source must not be accessed directly while wrapped.
+template<class DS>
+class PrefetchingSource: public DataSource<typename DS::val_t>, public Threadworker {
+public:
+    /// underlying source type
+    typedef DS dsrc_t;
+    /// retrieved value type
+    typedef typename DS::val_t val_t;
+
+    /// Constructor, wrapping source S (not owned) with nb items per read-ahead batch, up to nq batches queued
+    explicit PrefetchingSource(dsrc_t& S, size_t nb = 1024, size_t nq = 4): src(S), nbatch(nb), maxq(nq) { }
+    /// Destructor
+    ~PrefetchingSource() { finish_mythread(true); }
+
+    /// Fill supplied item with next object; return whether item has been updated
+    bool next(val_t& o) override {
+        if(ci >= cur.size() && !fetch()) return false;
+        o = cur[ci++];
+        ++this->nread;
+        return true;
+    }
+
+    /// View of next (up to nmax) objects directly from read-ahead buffer, valid until next read
+    span_view<val_t> next_batch(size_t nmax) override {
+        if(ci >= cur.size() && !fetch()) return {};
+        size_t n = std::min(nmax, cur.size() - ci);
+        span_view<val_t> v(cur.data() + ci, n);
+        ci += n;
+        this->nread += n;
+        return v;
+    }
+
+    /// Skip ahead n items: through read-ahead buffer, then in underlying source
+    bool skip(size_t n) override {
+        lock_guard<mutex> sl(srcMut);   // holds off background reads
+        {
+            lock_guard<mutex> lk(inputMut);
+            while(true) {
+                auto k = std::min(n, cur.size() - ci);
+                ci += k;
+                n -= k;
+                this->nread += k;
+                if(!n) return true;
+                if(!filled.size()) break;
+                rotate();
+            }
+            if(eof) return false;
+        }
+        bool ok = src.skip(n);
+        if(ok) this->nread += n;
+        lock_guard<mutex> lk(inputMut);
+        if(!ok) eof = true;
+        return ok;
+    }
+
+    /// Re-start at beginning of stream
+    void reset() override {
+        lock_guard<mutex> sl(srcMut);
+        src.reset();
+        lock_guard<mutex> lk(inputMut);
+        recycle(cur);
+        while(filled.size()) {
+            recycle(filled.front());
+            filled.pop_front();
+        }
+        ci = 0;
+        eof = false;
+        err = nullptr;
+        _DataSource::reset();
+        inputReady.notify_one();
+    }
+
+    /// Initialize for read start
+    void init_dsource() override {
+        lock_guard<mutex> sl(srcMut);
+        src.init_dsource();
+    }
+
+    /// start reading ahead
+    void prefetch() override { if(!checkRunning()) launch_mythread(); }
+
+    /// Estimate remaining data size (no loop), from underlying source
+    size_t entries() const override {
+        lock_guard<mutex> sl(srcMut);
+        return src.entries();
+    }
+
+protected:
+    dsrc_t& src;                    ///< underlying source
+    size_t nbatch;                  ///< items per read-ahead batch
+    size_t maxq;                    ///< maximum queued batches
+    mutable mutex srcMut;           ///< lock on underlying source access
+    std::condition_variable dataReady;  ///< batch available (or end of data) notifier
+    std::deque<vector<val_t>> filled;   ///< read-ahead batches
+    vector<vector<val_t>> spare;    ///< emptied batch buffers for re-use
+    vector<val_t> cur;              ///< batch being consumed
+    size_t ci = 0;                  ///< read position in cur
+    bool eof = false;               ///< whether underlying source has reached end
+    std::exception_ptr err;         ///< exception from background read, to re-throw to consumer
+
+    /// return batch buffer to spares (holding inputMut)
+    void recycle(vector<val_t>& v) {
+        v.clear();
+        if(v.capacity()) spare.push_back(std::move(v));
+        v = vector<val_t>();
+    }
+
+    /// replace cur with next filled batch (holding inputMut)
+    void rotate() {
+        recycle(cur);
+        cur = std::move(filled.front());
+        filled.pop_front();
+        ci = 0;
+        inputReady.notify_one();
+    }
+
+    /// wait for next batch into cur; return false at end of data
+    bool fetch() {
+        if(!checkRunning()) launch_mythread();
+        unique_lock<mutex> lk(inputMut);
+        dataReady.wait(lk, [this] { return filled.size() || eof; });
+        if(filled.size()) {
+            rotate();
+            return true;
+        }
+        if(err) std::rethrow_exception(std::exchange(err, nullptr));   // after batches read before failure
+        return false;
+    }
+
+    /// background read-ahead loop
+    void threadjob() override {
+        vector<val_t> buf;
+        while(true) {
+            check_pause();
+            {
+                unique_lock<mutex> lk(inputMut);
+                inputReady.wait(lk, [this] { return runstat != RUNNING || (!eof && filled.size() < maxq); });
+                if(runstat == STOP_REQUESTED) break;
+                if(runstat != RUNNING) continue;
+                if(spare.size()) {
+                    buf = std::move(spare.back());
+                    spare.pop_back();
+                }
+            }
+
+            lock_guard<mutex> sl(srcMut);
+            std::exception_ptr e;
+            try {
+                auto b = src.next_batch(nbatch);
+                buf.assign(b.begin(), b.end());
+            } catch(...) { e = std::current_exception(); }
+
+            lock_guard<mutex> lk(inputMut);
+            if(e) {
+                err = e;
+                eof = true;
+            } else if(buf.size()) filled.push_back(std::move(buf));
+            else eof = true;
+            buf = vector<val_t>();
+            dataReady.notify_one();
+        }
+    }
+};
+
+#endif
@@ -6,6 +6,7 @@
 #include "AnalysisStep.hh"
 #include "AnaGlobals.hh"
 #include "TermColor.hh"
+#include "Threadworker.hh"
 
 int RunCfgCmd::main(int argc, char** argv, const char* execname) {
     printf(TERMSGR_ITALIC "\n");
@@ -21,6 +22,7 @@ int RunCfgCmd::main(int argc, char** argv, const char* execname) {
     }
 
     loadGlobalArgs(argc - 2, argv + 2);
+    optionalGlobalArg("threadPool", Threadworker::pool_default, "run worker threads on shared re-usable thread pool");
     pre_run();
 
     try {
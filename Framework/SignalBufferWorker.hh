@@ -0,0 +1,69 @@
+/// @file SignalBufferWorker.hh Ping-pong buffer worker passing datastream signals in order with items
+
+#ifndef SIGNALBUFFERWORKER_HH
+#define SIGNALBUFFERWORKER_HH
+
+#include "PingpongBufferWorker.hh"
+#include "SignalSink.hh"
+
+/// PingpongBufferWorker with signals queued at their position in the item stream,
+/// delivered interleaved with items (in original order) from the worker thread
+template<typename T>
+class SignalBufferWorker: public PingpongBufferWorker<T> {
+public:
+    typedef PingpongBufferWorker<T> PBW;
+    using typename PBW::Tmut_t;
+
+    /// buffered signal
+    struct bufsig_t {
+        size_t i;                   ///< datastream position
+        datastream_signal_t sig;    ///< signal
+    };
+
+    /// queue signal at current position in stream
+    void queue_signal(datastream_signal_t sig) {
+        lock_guard<mutex> l(this->inputMut);
+        sigq.push_back({PBW::datq.size(), sig});
+        this->inputReady.notify_one();
+    }
+
+protected:
+    vector<bufsig_t> sigq;      ///< signals input FIFO
+    vector<bufsig_t> _sigq;     ///< ping-pong for sigq
+
+    /// deliver one output item, in worker thread
+    virtual void process_item(Tmut_t& x) = 0;
+    /// deliver one output signal, in worker thread
+    virtual void process_signal(datastream_signal_t sig) = 0;
+
+    /// discard oldest input items, keeping queued signals in place
+    void drop_oldest(size_t n) override {
+        for(auto& s: sigq) s.i = s.i > n? s.i - n : 0;
+        PBW::drop_oldest(n);
+    }
+
+    /// swap input/output buffers
+    void pingpong() override {
+        PBW::pingpong();
+        std::swap(sigq, _sigq);
+    }
+
+    /// process output buffers, in stream order
+    void processout() override {
+        PBW::processout();
+        auto& q = PBW::_datq;
+        size_t i = 0;
+        auto sit = _sigq.begin();
+        while(sit != _sigq.end() || i < q.size()) {
+            while(sit != _sigq.end() && sit->i <= i) {
+                process_signal(sit->sig);
+                ++sit;
+            }
+            if(i < q.size()) process_item(q[i]);
+            ++i;
+        }
+        _sigq.clear();
+    }
+};
+
+#endif
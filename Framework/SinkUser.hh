@@ -8,6 +8,9 @@
 #include "_SinkUser.hh"
 #include "DataSink.hh"
 
+template<typename T>
+DataSink<T>* profileStage(DataSink<T>* snk, const Setting& S);
+
 /// Base class outputting to a sink
 template<typename T>
 class SinkUser: virtual public _SinkUser {
@@ -56,7 +59,7 @@ public:
     SignalSink* makeDataSink(const Setting& S, const string& dfltclass = "") const override {
         auto snk = constructCfgObj<DataSink<T>>(S, dfltclass);
         if(snk) snk->initialize();
-        return snk;
+        return profileStage(snk, S);
     }
 
     /// pass through data flow signal
@@ -116,6 +119,8 @@ public:
 
     /// pass input to pre-filter
     void push(input_t& o) override { PreTransform.push(o); }
+    /// pass input batch to pre-filter
+    void push_batch(typename DataSink<input_t>::span_t v) override { PreTransform.push_batch(v); }
     /// pass through signals
     void signal(datastream_signal_t s) override { PreTransform.signal(s); }
 
@@ -133,4 +138,6 @@ const _AnaIndex& SinkUser<T>::getSinkIdx() const {
     return I;
 }
 
+#include "ProfilingSink.hh"
+
 #endif
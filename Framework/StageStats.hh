@@ -0,0 +1,32 @@
+/// @file StageStats.hh Per-stage pipeline performance statistics
+
+#ifndef STAGESTATS_HH
+#define STAGESTATS_HH
+
+#include <string>
+using std::string;
+#include <cstddef>
+
+/// Performance statistics for one pipeline stage
+struct StageStats {
+    string name;                ///< stage identifier
+    size_t n_items = 0;         ///< number of items received
+    size_t n_timed = 0;         ///< number of items with timing measured (< n_items when sampling)
+    double t_push = 0;          ///< (estimated) time in push(), excluding downstream stages [s]
+    size_t n_signals = 0;       ///< number of signals received
+    double t_signal = 0;        ///< time handling signals, excluding downstream stages [s]
+    size_t queue_hwm = 0;       ///< queue depth high-water mark (if stage queues items)
+    size_t n_disordered = 0;    ///< number of out-of-order items dropped or forcing a flush (if stage orders items)
+    size_t n_dropped = 0;       ///< number of items discarded by queue overflow policy
+};
+
+/// Interface for stages reporting internal queue statistics
+class StageMetrics {
+public:
+    /// Polymorphic destructor
+    virtual ~StageMetrics() { }
+    /// fill in stage-specific statistics (queue_hwm, n_disordered, n_dropped)
+    virtual void getStageMetrics(StageStats& S) const = 0;
+};
+
+#endif
@@ -0,0 +1,270 @@
+/// @file StaticPipeline.hh Compile-time fused analysis chains, without virtual dispatch between stages
+
+#ifndef STATICPIPELINE_HH
+#define STATICPIPELINE_HH
+
+#include "SinkUser.hh"
+#include <type_traits>
+
+/// Marker base for static (non-virtual) pipeline stages, which provide:
+///  - typedefs sink_t (input type) and output_t
+///  - template<class N> void push(sink_t& o, N& next), calling next.push(output_t&) for each output
+///  - optionally, template<class N> void signal(datastream_signal_t, N& next)
+///  - optionally, void configure(const Setting&)
+class StaticStage {
+public:
+    /// pass signal along chain
+    template<class N>
+    void signal(datastream_signal_t s, N& next) { next.signal(s); }
+};
+
+/// Static stage passing items selected by predicate
+template<typename T, class Pred>
+class StaticFilter: public StaticStage {
+public:
+    typedef T sink_t;       ///< input type
+    typedef T output_t;     ///< output type
+
+    /// pass selected items
+    template<class N>
+    void push(sink_t& o, N& next) {
+        if(pred(o)) next.push(o);
+        else ++n_rejected;
+    }
+
+    Pred pred;              ///< selection predicate, bool pred(const T&)
+    size_t n_rejected = 0;  ///< number of items rejected
+};
+
+/// Static stage transforming each item
+template<typename In, typename Out, class F>
+class StaticTransform: public StaticStage {
+public:
+    typedef In sink_t;      ///< input type
+    typedef Out output_t;   ///< output type
+
+    /// pass transformed item
+    template<class N>
+    void push(sink_t& o, N& next) {
+        output_t x = f(o);
+        next.push(x);
+    }
+
+    F f;    ///< transform, Out f(In&)
+};
+
+/// Static stage S as a (virtual) DataLink, for use in dynamically-assembled chains
+template<class S>
+class StageLink: public DataLink<typename S::sink_t, typename S::output_t> {
+public:
+    /// input type
+    typedef typename S::sink_t sink_t;
+
+    /// pass through stage to next
+    void push(sink_t& o) override { if(this->nextSink) stage.push(o, *this->nextSink); }
+    /// pass signal through stage
+    void signal(datastream_signal_t s) override { if(this->nextSink) stage.signal(s, *this->nextSink); }
+
+    S stage;    ///< wrapped stage
+};
+
+/// whether S is a terminal (DataSink-only) stage
+template<class S>
+struct _is_terminal_stage: std::integral_constant<bool, !std::is_base_of<StaticStage, S>::value && !std::is_base_of<_SinkUser, S>::value> { };
+
+/// Exit from end of static chain into (virtual) output sink
+template<typename T>
+class _StaticExit {
+public:
+    /// pass to output
+    void push(T& o) { if(*next) (*next)->push(o); }
+    /// signal output
+    void signal(datastream_signal_t s) { if(*next) (*next)->signal(s); }
+
+    DataSink<T>* const* next = nullptr; ///< pointer to owning pipeline's nextSink
+};
+
+/// No exit after terminal stage
+class _NoExit { };
+
+/// DataSink<T> output of dynamic link stage, back into rest of static chain
+template<typename T, class N>
+class _ChainSink: public DataSink<T> {
+public:
+    /// Constructor
+    explicit _ChainSink(N& n): next(n) { }
+    /// pass to rest of chain
+    void push(T& o) override { next.push(o); }
+    /// signal rest of chain
+    void signal(datastream_signal_t s) override { next.signal(s); }
+protected:
+    N& next;    ///< rest of chain
+};
+
+/// Fused chain of stages, ending in exit X; empty chain is the exit
+template<class X, class... Stages>
+class _StaticChain: public X {
+public:
+    /// get exit
+    X& exit() { return *this; }
+    /// no stages to configure
+    void configure(const Setting&, int) { }
+};
+
+/// Fused chain node: Stage followed by rest of chain
+template<class X, class Stage, class... Rest>
+class _StaticChain<X, Stage, Rest...> {
+public:
+    /// rest of chain type
+    typedef _StaticChain<X, Rest...> rest_t;
+    static_assert(!_is_terminal_stage<Stage>::value || !sizeof...(Rest), "Terminal sink stage must be last in pipeline");
+
+    /// Constructor
+    _StaticChain() { connect(stage, 0); }
+    /// Destructor
+    ~_StaticChain() { delete link; }
+    /// no copying (link output refers to this)
+    _StaticChain(const _StaticChain&) = delete;
+    /// no copying (link output refers to this)
+    _StaticChain& operator=(const _StaticChain&) = delete;
+
+    /// push through stage
+    template<typename U>
+    void push(U& o) { push_imp(stage, o, 0); }
+    /// signal through stage
+    void signal(datastream_signal_t s) { signal_imp(stage, s, 0); }
+    /// get exit
+    X& exit() { return rest.exit(); }
+    /// configure stages from i^th and following entries of "stages" list
+    void configure(const Setting& S, int i) {
+        if(S.exists("stages") && S["stages"].getLength() > i) configure_imp(stage, S["stages"][i], 0);
+        rest.configure(S, i + 1);
+    }
+
+    Stage stage;    ///< this stage
+    rest_t rest;    ///< following stages
+
+protected:
+    SignalSink* link = nullptr; ///< output of dynamic link stage into rest
+
+    /// static stage: direct call
+    template<class SS, typename U>
+    auto push_imp(SS& s, U& o, int) -> decltype(s.push(o, rest), void()) { s.push(o, rest); }
+    /// link or terminal stage: non-virtual call
+    template<class SS, typename U>
+    void push_imp(SS& s, U& o, long) { s.SS::push(o); }
+
+    /// static stage signal
+    template<class SS>
+    auto signal_imp(SS& s, datastream_signal_t sig, int) -> decltype(s.signal(sig, rest), void()) { s.signal(sig, rest); }
+    /// link or terminal stage signal
+    template<class SS>
+    void signal_imp(SS& s, datastream_signal_t sig, long) { s.SS::signal(sig); }
+
+    /// dynamic link stage: output to rest of chain
+    template<class SS>
+    auto connect(SS& s, int) -> decltype(s.getNext(), void()) {
+        auto c = new _ChainSink<typename SS::output_t, rest_t>(rest);
+        link = c;
+        s.getNext() = c;
+        s.setOwnsNext(false);
+    }
+    /// static or terminal stage: nothing to connect
+    template<class SS>
+    void connect(SS&, long) { }
+
+    /// configurable stage
+    template<class SS>
+    static auto configure_imp(SS& s, const Setting& S, int) -> decltype(s.configure(S), void()) { s.configure(S); }
+    /// non-configurable stage
+    template<class SS>
+    static void configure_imp(SS&, const Setting&, long) { }
+};
+
+/// get i^th stage of chain
+template<size_t i>
+struct _chain_get {
+    /// get stage
+    template<class C>
+    static auto& get(C& c) { return _chain_get<i - 1>::get(c.rest); }
+};
+/// get first stage of chain
+template<>
+struct _chain_get<0> {
+    /// get stage
+    template<class C>
+    static auto& get(C& c) { return c.stage; }
+};
+
+/// first type in list
+template<class S, class... Rest>
+struct _first_stage { typedef S type; };
+/// last type in list
+template<class S, class... Rest>
+struct _last_stage: _last_stage<Rest...> { };
+/// last type in list
+template<class S>
+struct _last_stage<S> { typedef S type; };
+
+/// pipeline base and exit types: DataLink for chains with output
+template<typename In, class Last, bool terminal = _is_terminal_stage<Last>::value>
+struct _pipeline_traits {
+    typedef typename Last::output_t output_t;   ///< pipeline output type
+    typedef DataLink<In, output_t> base_t;      ///< pipeline base class
+    typedef _StaticExit<output_t> exit_t;       ///< chain exit
+};
+/// pipeline base and exit types: DataSink for chains ending in a terminal sink
+template<typename In, class Last>
+struct _pipeline_traits<In, Last, true> {
+    typedef DataSink<In> base_t;    ///< pipeline base class
+    typedef _NoExit exit_t;         ///< chain exit
+};
+
+/// Fused chain of stages, inlined into a single DataSink (or DataLink, if the last stage has output).
+/// Stages may be StaticStage types (called directly), dynamic DataLinks such as OrderingQueue
+/// (called non-virtually, with a single virtual hop from their output back into the chain),
+/// or a final terminal DataSink. Stages are default-constructed, then accessed with get<i>().
+template<class... Stages>
+class StaticPipeline: public _pipeline_traits<typename _first_stage<Stages...>::type::sink_t, typename _last_stage<Stages...>::type>::base_t {
+public:
+    /// input type
+    typedef typename _first_stage<Stages...>::type::sink_t sink_t;
+    /// traits
+    typedef _pipeline_traits<sink_t, typename _last_stage<Stages...>::type> traits_t;
+    /// fused chain type
+    typedef _StaticChain<typename traits_t::exit_t, Stages...> chain_t;
+
+    /// Constructor
+    StaticPipeline() { connectExit(chain.exit()); }
+    /// Constructor, from config file: optional "stages" list of per-stage settings, and "next" output
+    explicit StaticPipeline(const Setting& S): StaticPipeline() {
+        chain.configure(S, 0);
+        auto su = dynamic_cast<_SinkUser*>(this);
+        if(su && S.exists("next")) su->createOutput(S["next"]);
+    }
+
+    /// push through chain
+    void push(sink_t& o) override { chain.push(o); }
+    /// push batch through chain, without per-item virtual dispatch
+    void push_batch(typename DataSink<sink_t>::span_t v) override { for(auto& o: v) chain.push(o); }
+    /// signal through chain
+    void signal(datastream_signal_t s) override { chain.signal(s); }
+
+    /// get i^th stage
+    template<size_t i>
+    auto& get() { return _chain_get<i>::get(chain); }
+
+protected:
+    chain_t chain;  ///< fused stages
+
+    /// point exit to nextSink
+    template<typename T>
+    void connectExit(_StaticExit<T>& x) { x.next = &this->getNext(); }
+    /// no exit to connect
+    void connectExit(_NoExit&) { }
+};
+
+/// Define pre-fused pipeline type NAME from stages, registered for construction by name as DataSink of its input
+#define REGISTER_PIPELINE(NAME, ...) typedef StaticPipeline<__VA_ARGS__> NAME; REGISTER_CONFIG(NAME, DataSink<NAME::sink_t>)
+
+#endif
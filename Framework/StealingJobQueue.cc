@@ -0,0 +1,200 @@
+/// @file StealingJobQueue.cc
+
+#include "StealingJobQueue.hh"
+#include <algorithm>
+
+thread_local StealingJobQueue::worker_t* StealingJobQueue::current = nullptr;
+
+StealingJobQueue::~StealingJobQueue() {
+    shutdown();
+    for(auto& kv: jqs) delete kv.second;
+}
+
+StealingJobQueue::squeue& StealingJobQueue::getQueue(int qn) {
+    std::lock_guard<std::mutex> lk(jqsLock);
+    auto& q = jqs[qn];
+    if(!q) q = new squeue();
+    return *q;
+}
+
+StealingJobQueue::squeue& StealingJobQueue::getQueue(worker_t& W, int qn) {
+    auto it = W.qcache.find(qn);
+    if(it != W.qcache.end()) return *it->second;
+    auto& q = getQueue(qn);
+    W.qcache[qn] = &q;
+    return q;
+}
+
+void StealingJobQueue::setQueue(int qn, size_t max_workers, size_t backlog) {
+    auto& q = getQueue(qn);
+    q.max_workers = max_workers;
+    q.backlog = backlog;
+    std::lock_guard<std::mutex> lk(q.fifoLock);
+    release_fifo(q);
+}
+
+void StealingJobQueue::add(Job* J) {
+    if(!J) return;
+    auto W = myWorker();
+    auto& q = W? getQueue(*W, J->qn) : getQueue(J->qn);
+    if(verbose > 4) printf("Adding job to queue %i (backlog %zu)\n", J->qn, q.n_queued.load());
+    if(!W) jobDone.await([&]{ return q.n_queued.load() < q.backlog.load(); });
+    ++q.n_queued;
+    ++n_pending;
+    submit(q, J);
+}
+
+void StealingJobQueue::submit(squeue& q, Job* J) {
+    if(!isLimited(q) && !q.n_fifo) {
+        schedule(task_t(J));
+        return;
+    }
+    std::lock_guard<std::mutex> lk(q.fifoLock);
+    q.fifo.push_back(J);
+    ++q.n_fifo;
+    release_fifo(q);
+}
+
+void StealingJobQueue::release_fifo(squeue& q) {
+    while(q.fifo.size() && q.n_workers.load() < q.max_workers.load()) {
+        ++q.n_workers;
+        auto J = q.fifo.front();
+        q.fifo.pop_front();
+        --q.n_fifo;
+        schedule(task_t(J) | 1);
+    }
+}
+
+void StealingJobQueue::schedule(task_t T) {
+    ++n_ready;
+    auto W = myWorker();
+    if(W) W->dq.push(T);
+    else {
+        std::lock_guard<std::mutex> lk(injectLock);
+        inject.push_back(T);
+        ++n_inject;
+    }
+    wakeWorker.notify_one();
+}
+
+bool StealingJobQueue::findTask(worker_t& W, task_t& T) {
+    if(W.dq.pop(T)) {
+        --n_ready;
+        return true;
+    }
+
+    if(n_inject.load()) {
+        // take a share of the injection queue, moving the rest onto own deque for others to steal
+        std::lock_guard<std::mutex> lk(injectLock);
+        size_t n = std::min(inject.size(), size_t(64));
+        if(n > 1) n = std::max(size_t(1), std::min(n, inject.size() / nworkers.load()));
+        if(n) {
+            T = inject.front();
+            for(size_t i = n - 1; i > 0; --i) W.dq.push(inject[i]); // reversed, to pop in submission order
+            inject.erase(inject.begin(), inject.begin() + n);
+            n_inject -= n;
+            --n_ready;
+            return true;
+        }
+    }
+
+    auto nw = workers.size();
+    for(size_t k = 0; k < nw; ++k) {
+        auto V = workers[(W.victim + k) % nw];
+        if(V == &W || !V->dq.steal(T)) continue;
+        W.victim = V->i;
+        --n_ready;
+        ++nStolen;
+        return true;
+    }
+    return false;
+}
+
+void StealingJobQueue::runTask(worker_t& W, task_t T) {
+    bool hasSlot = T & 1;
+    auto J = reinterpret_cast<Job*>(T & ~task_t(1));
+    auto qn = J->qn;
+    auto& q = getQueue(W, qn);
+    if(!hasSlot) ++q.n_workers;
+    --q.n_queued;
+    jobDone.notify();
+
+    if(verbose > 1) { printf("Worker %zu running job %p from queue %i\n", W.i, (void*)J, qn); fflush(stdout); }
+    J->run();
+    if(verbose > 1) { printf("Worker %zu completed job %p from queue %i\n", W.i, (void*)J, qn); fflush(stdout); }
+
+    // release worker slot, passing it on to next FIFO job if waiting
+    if(hasSlot) {
+        std::lock_guard<std::mutex> lk(q.fifoLock);
+        --q.n_workers;
+        release_fifo(q);
+    } else {
+        --q.n_workers;
+        if(q.n_fifo.load()) {
+            std::lock_guard<std::mutex> lk(q.fifoLock);
+            release_fifo(q);
+        }
+    }
+
+    if(!--n_pending) jobDone.notify();
+}
+
+void StealingJobQueue::doWork(worker_t& W) {
+    current = &W;
+    if(verbose) printf("Starting worker %zu thread.\n", W.i);
+
+    task_t T;
+    while(true) {
+        if(findTask(W, T)) {
+            runTask(W, T);
+            continue;
+        }
+        if(halt) break;
+        if(verbose > 1) { printf("Worker %zu awaiting job.\n", W.i); fflush(stdout); }
+        wakeWorker.await([this]{ return n_ready.load() || halt.load(); });
+    }
+
+    if(verbose) printf("Stopping worker %zu thread.\n", W.i);
+    current = nullptr;
+}
+
+void StealingJobQueue::launch(size_t nw) {
+    if(workers.size() || !nw) return; // already running
+    halt = false;
+    for(size_t i = 0; i < nw; ++i) workers.push_back(new worker_t(*this, i));
+    for(auto W: workers) W->victim = (W->i + 1) % nw;
+    nworkers = nw;
+    for(auto W: workers) W->t = std::thread([this, W] { doWork(*W); });
+}
+
+void StealingJobQueue::flush() {
+    if(verbose) { printf("Flushing "); display(); }
+    jobDone.await([this]{ return !n_pending.load(); });
+}
+
+void StealingJobQueue::display() {
+    std::lock_guard<std::mutex> lk(jqsLock);
+    printf("StealingJobQueue with %zu pending jobs (%zu ready), %zu workers, %zu stolen:\n",
+           n_pending.load(), n_ready.load(), workers.size(), nStolen.load());
+    for(auto& kv: jqs) {
+        auto& q = *kv.second;
+        printf("\tQueue %i: running %zu/%zu workers, backlog %zu/%zu.\n",
+               kv.first, q.n_workers.load(), q.max_workers.load(), q.n_queued.load(), q.backlog.load());
+    }
+}
+
+void StealingJobQueue::shutdown() {
+    if(!workers.size()) return;
+
+    flush();
+    if(verbose) printf("Shutting down worker threads.\n");
+    halt = true;
+    wakeWorker.notify();
+    for(auto W: workers) {
+        W->t.join();
+        delete W;
+    }
+    workers.clear();
+    nworkers = 0;
+    halt = false;
+}
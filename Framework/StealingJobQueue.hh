@@ -0,0 +1,116 @@
+/// @file StealingJobQueue.hh Work-stealing parallel job executor, without a central controller thread
+
+#ifndef STEALINGJOBQUEUE_HH
+#define STEALINGJOBQUEUE_HH
+
+#include "JobQueue.hh"
+#include "ChaseLevDeque.hh"
+#include "SPSCRing.hh"
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+/// Work-stealing parallel job executor, with the same job API as JobQueue
+/// Each worker runs jobs from its own lock-free deque (newest first), then from a shared injection
+/// queue of externally-submitted jobs, then steals (oldest first) from other workers. Jobs added from
+/// inside a running job go to the current worker's deque, skipping the backlog wait.
+/// Queues limited to fewer workers than available keep a per-queue FIFO, released into the deques as
+/// worker slots become available; so a max_workers = 1 queue still runs strictly serially, in order.
+class StealingJobQueue: private boost::noncopyable {
+public:
+    typedef JobQueue::Job Job;  ///< job base class
+
+    /// Destructor
+    ~StealingJobQueue();
+
+    /// configure queue settings
+    void setQueue(int qn, size_t max_workers, size_t backlog = 10000);
+    /// add a job, waiting as needed until queue is down to 'backlog' entries
+    void add(Job* J);
+    /// launch specified number of workers
+    void launch(size_t nw);
+    /// wait until all queues are empty
+    void flush();
+    /// flush and close worker threads
+    void shutdown();
+    /// display current queue status
+    void display();
+
+    int verbose = 0;    ///< debugging verbosity
+
+    /// number of jobs obtained by stealing from another worker
+    size_t n_stolen() const { return nStolen.load(); }
+
+protected:
+    /// queue for a particular kind of job
+    struct squeue {
+        std::atomic<size_t> max_workers{1000};  ///< max. parallel jobs (1 for strictly serial)
+        std::atomic<size_t> n_workers{0};       ///< current number of running (or slot-holding) jobs
+        std::atomic<size_t> backlog{10000};     ///< maximum backlog before holding up new job submissions
+        std::atomic<size_t> n_queued{0};        ///< jobs submitted but not yet started
+        std::mutex fifoLock;                    ///< lock on fifo (and slot-holding n_workers changes)
+        deque<Job*> fifo;                       ///< jobs waiting for worker slot, on limited queues
+        std::atomic<size_t> n_fifo{0};          ///< fifo.size(), for lock-free checking
+    };
+
+    /// scheduled job: job pointer, with low bit tagging a job holding a limited-queue worker slot
+    typedef uintptr_t task_t;
+
+    /// per-worker state
+    struct worker_t {
+        /// Constructor
+        worker_t(StealingJobQueue& jq, size_t n): JQ(jq), i(n) { }
+        StealingJobQueue& JQ;           ///< parent executor
+        const size_t i;                 ///< worker number
+        ChaseLevDeque<task_t> dq;       ///< local job deque
+        map<int, squeue*> qcache;       ///< local cache of queue lookups
+        std::thread t;                  ///< the thread
+        size_t victim = 0;              ///< next steal victim
+    };
+
+    /// worker thread loop
+    void doWork(worker_t& W);
+    /// find next task for worker (own deque, injection queue, steal); return false if none
+    bool findTask(worker_t& W, task_t& T);
+    /// run one task, and release or hand on its queue slot
+    void runTask(worker_t& W, task_t T);
+    /// schedule task from current thread (worker deque, or injection queue)
+    void schedule(task_t T);
+    /// submit job subject to its queue's limits (n_queued, n_pending already counted)
+    void submit(squeue& q, Job* J);
+    /// (holding q.fifoLock) start FIFO-waiting jobs while worker slots are available
+    void release_fifo(squeue& q);
+
+    /// get (or create) queue category
+    squeue& getQueue(int qn);
+    /// get queue category, with lock-free per-worker cache
+    squeue& getQueue(worker_t& W, int qn);
+    /// whether queue must use worker slot FIFO (always before launch, and for serial queues)
+    bool isLimited(const squeue& q) const {
+        auto nw = nworkers.load();
+        auto mw = q.max_workers.load();
+        return !nw || mw < nw || mw == 1;
+    }
+    /// worker running in current thread (nullptr outside workers)
+    static thread_local worker_t* current;
+    /// current thread's worker, if it belongs to this executor
+    worker_t* myWorker() const { return current && &current->JQ == this? current : nullptr; }
+
+    map<int, squeue*> jqs;                  ///< queue categories
+    std::mutex jqsLock;                     ///< lock on jqs map
+
+    vector<worker_t*> workers;              ///< worker threads
+    std::atomic<size_t> nworkers{0};        ///< number of workers (0 before launch)
+    std::mutex injectLock;                  ///< lock on inject
+    deque<task_t> inject;                   ///< jobs submitted from outside worker threads
+    std::atomic<size_t> n_inject{0};        ///< inject.size(), for lock-free checking
+
+    std::atomic<size_t> n_ready{0};         ///< tasks in deques and injection queue
+    std::atomic<size_t> n_pending{0};       ///< jobs added but not completed
+    std::atomic<size_t> nStolen{0};         ///< count of stolen jobs
+    std::atomic<bool> halt{false};          ///< signal for threads to halt
+    FutexEvent wakeWorker;                  ///< idle worker wakeup
+    FutexEvent jobDone;                     ///< wakeup for flush and backlog waits
+};
+
+#endif
@@ -4,75 +4,248 @@
 #ifndef THREADBUFFERSINK_HH
 #define THREADBUFFERSINK_HH
 
-#include "DataSink.hh"
-#include "PingpongBufferWorker.hh"
+#include "SinkUser.hh"
+#include "SignalBufferWorker.hh"
+#include "SPSCRing.hh"
+#include "StageStats.hh"
+#include "BackpressureGate.hh"
+#include "ConfigPlacement.hh"
 #include <unistd.h>
+#include <atomic>
+#include <functional>
+#include <iterator>
+#include <algorithm>
 
 /// Buffered input to sink running in independent thread
 template<typename T>
-class ThreadBufferSink: public DataLink<T,T>, public PingpongBufferWorker<T>, public Configurable {
+class ThreadBufferSink: public DataLink<T,T>, public SignalBufferWorker<T>, public Configurable, public StageMetrics {
 public:
     using DataLink<T,T>::nextSink;
-    typedef PingpongBufferWorker<T> PBW;
+    typedef SignalBufferWorker<T> SBW;
+    typedef typename SBW::PBW PBW;
     using PBW::verbose;
     using PBW::_datq;
+    using typename PBW::Tmut_t;
+
+    /// transport mechanism between input and processing threads
+    enum transport_t {
+        TRANSPORT_PINGPONG = 0, ///< mutex-locked swapped input/output buffers
+        TRANSPORT_RING     = 1  ///< lock-free bounded ring, with in-band signals
+    } transport = TRANSPORT_PINGPONG;
 
     /// Configuration constructor
     explicit ThreadBufferSink(const Setting& S): Configurable(S) {
         Cfg.lookupValue("verbose", verbose, "threading debug verbosity level");
+        Cfg.lookupEnum("transport", transport, "inter-thread transport mechanism",
+                       {{"pingpong", TRANSPORT_PINGPONG}, {"ring", TRANSPORT_RING}});
+        if(transport == TRANSPORT_RING) {
+            int nring = ring.capacity();
+            Cfg.lookupValue("ring_size", nring, "ring transport capacity (rounded up to power of 2)");
+            if(nring <= 0) throw std::runtime_error("ThreadBufferSink ring_size must be positive");
+            ring.allocate(nring);
+        }
+
+        int n = 0;
+        if(Cfg.lookupValue("capacity", n, "maximum queued input items (0 for unlimited; ring transport is always bounded)")) PBW::capacity = std::max(n, 0);
+        Cfg.lookupEnum("overflow", PBW::overflow, "policy for input at capacity",
+                       {{"block", PBW::OVERFLOW_BLOCK}, {"drop_oldest", PBW::OVERFLOW_DROP_OLDEST}, {"drop_newest", PBW::OVERFLOW_DROP_NEWEST}});
+        if(transport == TRANSPORT_RING && PBW::overflow == PBW::OVERFLOW_DROP_OLDEST)
+            throw std::runtime_error("ThreadBufferSink ring transport does not support overflow = drop_oldest (use block or drop_newest)");
+        n = 0;
+        if(Cfg.lookupValue("high_water", n, "queued items signalling upstream backpressure")) {
+            PBW::high_water = std::max(n, 0);
+            n = PBW::high_water / 2;
+            Cfg.lookupValue("low_water", n, "queued items releasing upstream backpressure");
+            PBW::low_water = std::max(n, 0);
+        }
+        if(transport == TRANSPORT_RING && PBW::high_water >= ring.capacity())
+            throw std::runtime_error("ThreadBufferSink high_water must be below ring transport capacity");
+        string gate;
+        if(Cfg.lookupValue("backpressure", gate, "named gate throttling upstream sources while above high_water"))
+            PBW::watermark_cb = BackpressureGate::named(gate).listener();
+        configurePlacement(*this, Cfg);
         if(Cfg.show_exists("next", "ThreadBufferSink downstream analysis chain")) this->createOutput(Cfg["next"]);
     }
 
     /// receive item to queue
-    void push(T& o) override { PBW::add_item(o); }
+    void push(T& o) override {
+        ++depth;
+        if(transport == TRANSPORT_RING && this->checkRunning()) ring_push(o);
+        else PBW::add_item(o);
+    }
 
-    /// buffered signal
-    struct bufsig_t {
-        size_t i;                   ///< datastream position
-        datastream_signal_t sig;    ///< signal
-    };
+    /// receive batch of items to queue
+    void push_batch(typename DataSink<T>::span_t v) override {
+        depth += v.size();
+        if(transport == TRANSPORT_RING && this->checkRunning()) for(auto& o: v) ring_push(o);
+        else PBW::add_items(v.begin(), v.end());
+    }
+
+    /// number of items received but not yet passed downstream
+    size_t queue_depth() const { return depth.load(std::memory_order_relaxed); }
+
+    /// work-stealing hook, called from idle worker thread: return whether stolen work was added
+    std::function<bool(ThreadBufferSink&)> steal_hook;
+
+    /// From steal_hook (holding own inputMut, via idle_work): move about the newer half of victim V's queued batches,
+    /// starting at the earliest batch at or after halfway accepted by ok(first, last item);
+    /// no stealing across signals queued in either victim or thief
+    bool steal_from(ThreadBufferSink& V, const std::function<bool(const Tmut_t&, const Tmut_t&)>& ok) {
+        if(&V == this || V.transport != TRANSPORT_PINGPONG || sigq.size()) return false;
+        unique_lock<mutex> lk(V.inputMut, std::try_to_lock);    // no waiting (or lock-order deadlock) on busy victim
+        if(!lk.owns_lock() || !V.datq_batches.size() || V.sigq.size()) return false;
+
+        auto it = std::lower_bound(V.datq_batches.begin(), V.datq_batches.end(), V.datq.size() / 2);
+        while(it != V.datq_batches.end() && !ok(V.datq[*it], V.datq.back())) ++it;
+        if(it == V.datq_batches.end()) return false;
+
+        size_t i0 = *it, n = V.datq.size() - i0;
+        for(auto jt = it; jt != V.datq_batches.end(); ++jt)
+            PBW::datq_batches.push_back(PBW::datq.size() + *jt - i0);
+        PBW::datq.insert(PBW::datq.end(), std::make_move_iterator(V.datq.begin() + i0), std::make_move_iterator(V.datq.end()));
+        V.datq.erase(V.datq.begin() + i0, V.datq.end());
+        V.datq_batches.erase(it, V.datq_batches.end());
+        V.depth -= n;
+        depth += n;
+        ++n_stolen;
+        if(V.capacity) V.spaceReady.notify_all();
+        return true;
+    }
+
+    std::atomic<size_t> n_stolen{0};    ///< number of work-stealing transfers into this queue (read from other threads)
+
+    /// report queue high-water mark and overflow drops
+    void getStageMetrics(StageStats& S) const override {
+        S.queue_hwm = std::max(S.queue_hwm, std::max(PBW::max_buffered(), ring_hwm.load(std::memory_order_relaxed)));
+        S.n_dropped += PBW::n_dropped;
+    }
 
     /// handle signals
     void signal(datastream_signal_t sig) override {
-        if(sig == DATASTREAM_INIT) PBW::launch_mythread();
-        {
-            lock_guard<mutex> l(PBW::inputMut);
-            sigq.push_back({PBW::datq.size(), sig});
-            PBW::inputReady.notify_one();
+        if(sig == DATASTREAM_INIT) launch_mythread();
+        if(transport == TRANSPORT_RING && this->checkRunning()) ring.emplace(sig);
+        else {
+            SBW::queue_signal(sig);
             sched_yield();
         }
-        if(sig >= DATASTREAM_END) PBW::finish_mythread(true);
+        if(sig >= DATASTREAM_END) finish_mythread(true);
+    }
+
+    /// launch worker thread
+    void launch_mythread() override {
+        ring.reopen();
+        PBW::launch_mythread();
+    }
+
+    /// close out thread and finish processing items
+    void finish_mythread(bool unlaunched_OK = false) override {
+        if(transport == TRANSPORT_RING) ring.close();
+        PBW::finish_mythread(unlaunched_OK);
+    }
+
+    /// thread to pull from queue and push downstream
+    void threadjob() override {
+        if(transport == TRANSPORT_RING) ring_threadjob();
+        else PBW::threadjob();
     }
 
 protected:
-    vector<bufsig_t> sigq;      ///< signals input FIFO
-    vector<bufsig_t> _sigq;     ///< ping-pong for sigq
+    using SBW::sigq;
+    std::atomic<size_t> depth{0};   ///< number of items received but not yet passed downstream
 
-    /// swap input/output buffers
-    void pingpong() override {
-        PBW::pingpong();
-        std::swap(sigq, _sigq);
+    /// record discarded items
+    void count_dropped(size_t n) override {
+        PBW::count_dropped(n);
+        depth -= n;
     }
 
-    /// process output buffers
-    void processout() override {
-        PBW::processout();
-
-        if(nextSink) {
-            size_t i = 0;
-            auto sit = _sigq.begin();
-            while(sit != _sigq.end() || i < _datq.size())  {
-                while(sit != _sigq.end() && sit->i <= i) {
-                    DataLink<T,T>::signal(sit->sig);
-                    ++sit;
-                }
-                if(i < _datq.size()) nextSink->push(_datq[i]);
-                sched_yield();
-                ++i;
+    /// try work-stealing when idle
+    bool idle_work() override { return steal_hook && steal_hook(*this); }
+
+    /// ring transport item: datum or in-band signal marker
+    struct ringitem_t {
+        /// Constructor for datum
+        explicit ringitem_t(const T& x): isSig(false) { new(&dat) Tmut_t(x); }
+        /// Constructor for signal
+        explicit ringitem_t(datastream_signal_t s): isSig(true), sig(s) { }
+        /// Destructor
+        ~ringitem_t() { if(!isSig) get().~Tmut_t(); }
+        /// get contained datum
+        Tmut_t& get() { return *reinterpret_cast<Tmut_t*>(&dat); }
+
+        bool isSig;                 ///< whether this is a signal marker
+        datastream_signal_t sig = DATASTREAM_NOOP;  ///< signal
+        typename std::aligned_storage<sizeof(Tmut_t), alignof(Tmut_t)>::type dat;   ///< datum storage
+    };
+    SPSCRing<ringitem_t> ring;  ///< ring transport input FIFO
+    std::atomic<size_t> ring_hwm{0};    ///< ring transport occupancy high-water mark (sampled; read by profiler)
+    std::atomic<bool> ring_above{false};    ///< whether ring high watermark crossing has been signalled
+
+    /// enqueue datum on ring, blocking or dropping it when full (DROP_OLDEST rejected at configuration: producer cannot discard queued items)
+    void ring_push(T& o) {
+        if(PBW::overflow != PBW::OVERFLOW_DROP_NEWEST) ring.emplace(o);
+        else if(!ring.try_emplace(o)) count_dropped(1);
+        ring_watermark();
+    }
+
+    /// check ring occupancy against watermarks, from producer or consumer; crossings notified under inputMut
+    void ring_watermark() {
+        if(!PBW::high_water || !PBW::watermark_cb) return;
+        if(ring_above.load(std::memory_order_relaxed)? ring.size() > PBW::low_water : ring.size() < PBW::high_water) return;
+        lock_guard<mutex> l(this->inputMut);
+        auto n = ring.size();
+        if(!ring_above && n >= PBW::high_water) {
+            ring_above = true;
+            PBW::watermark_cb(true);
+        } else if(ring_above && n <= PBW::low_water) {
+            ring_above = false;
+            PBW::watermark_cb(false);
+        }
+    }
+
+    /// ring transport processing loop
+    void ring_threadjob() {
+        while(true) {
+            if(this->runstat == Threadworker::PAUSE_REQUESTED) this->check_pause();
+            auto p = ring.wait_front(10000);    // periodic wakeup to catch pause requests
+            if(!p) {
+                if(ring.is_closed() && !ring.front()) break;
+                ring_watermark();   // release high crossing signalled after last pop
+                continue;
             }
+            if(p->isSig) DataLink<T,T>::signal(p->sig);
+            else {
+                if(nextSink) nextSink->push(p->get());
+                if(!(--depth & 63) && ring.size() > ring_hwm.load(std::memory_order_relaxed))
+                    ring_hwm.store(ring.size(), std::memory_order_relaxed);
+            }
+            ring.pop();
+            ring_watermark();
         }
 
-        _sigq.clear();
+        if(verbose > 3)
+            printf(TERMFG_BLUE "  ThreadBufferSink [%i] ring done (%zu full-queue waits)." TERMSGR_RESET "\n", this->worker_id, ring.n_full_waits);
+    }
+
+    /// allocate queue buffers in worker thread, for NUMA first-touch placement
+    void thread_init() override {
+        PBW::thread_init();
+        if(transport == TRANSPORT_RING && this->hasPlacement()) ring.allocate(ring.capacity());
+    }
+
+    /// pass item downstream
+    void process_item(Tmut_t& x) override {
+        if(nextSink) nextSink->push(x);
+        sched_yield();
+    }
+
+    /// pass signal downstream
+    void process_signal(datastream_signal_t sig) override { DataLink<T,T>::signal(sig); }
+
+    /// process output buffers
+    void processout() override {
+        SBW::processout();
+        depth -= _datq.size();
     }
 };
 
@@ -6,7 +6,7 @@
 
 #include "_Collator.hh"
 #include "ConfigThreader.hh"
-#include "GlobalArgs.hh"
+#include "ConfigPlacement.hh"
 #include <thread>
 
 /// Type-independent re-casting base
@@ -17,6 +17,7 @@ public:
     Configurable(S), XMLProvider("Collator"), nthreads(std::thread::hardware_concurrency()) {
         S.lookupValue("nthreads", nthreads);
         optionalGlobalArg("nParallel", nthreads, "number of parallel collated processes (0 for single-threaded)");
+        configurePlacement(*this, Cfg);
     }
 
     /// Destructor
@@ -6,6 +6,23 @@ _ConfigParallel::_ConfigParallel(const Setting& S):
 Configurable(S), XMLProvider("Parallel"), nparallel(std::thread::hardware_concurrency()) {
     Cfg.lookupValue("nthreads", nparallel);
     optionalGlobalArg("nParallel", nparallel, "number of parallel chains");
+
+    const map<string, placement_t> placements = {{"none", PLACE_NONE}, {"spread", PLACE_SPREAD}, {"compact", PLACE_COMPACT}};
+    Cfg.lookupEnum("placement", placement, "parallel chain CPU placement policy", placements);
+    string p;
+    if(optionalGlobalArg("placement", p, "parallel chain CPU placement policy (none, spread, compact)")) {
+        auto it = placements.find(p);
+        if(it == placements.end()) throw std::runtime_error("Unknown -placement policy '" + p + "' (none, spread, compact)");
+        placement = it->second;
+    }
+}
+
+void _ConfigParallel::placeThreads(const vector<Threadworker*>& v) {
+    if(placement == PLACE_NONE) return;
+    auto cores = physicalCores(placement);
+    if(!cores.size()) return;
+    size_t j = 0;
+    for(auto t: v) if(!t->hasPlacement()) t->cpus = cores[(j++) % cores.size()];
 }
 
 void _ConfigParallel::makeCollator() {
@@ -34,6 +51,7 @@ void _ConfigParallel::run() {
                 keep_me = CT;
             }
         } while(nth > 0);
+        placeThreads(vector<Threadworker*>(mythreads.begin(), mythreads.end()));
 
         if(Cfg.exists("next")) { // produces output (to be collated in multithreaded mode)
             if(nparallel > 0) makeCollator();
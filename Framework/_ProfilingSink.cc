@@ -0,0 +1,122 @@
+/// @file _ProfilingSink.cc
+
+#include "ProfilingSink.hh"
+#include "GlobalArgs.hh"
+#include "StringManip.hh"
+#include <algorithm>
+#include <fstream>
+
+std::mutex& _ProfilingSink::regLock() { static std::mutex m; return m; }
+
+vector<_ProfilingSink*>& _ProfilingSink::registry() { static vector<_ProfilingSink*> v; return v; }
+
+vector<StageStats>& _ProfilingSink::retired() { static vector<StageStats> v; return v; }
+
+bool _ProfilingSink::enabled() {
+    static bool e = wasArgGiven("profile", "per-stage pipeline profiling");
+    return e;
+}
+
+size_t _ProfilingSink::sampleEvery() {
+    static size_t n = [] {
+        int i = 1;
+        optionalGlobalArg("profileSample", i, "profile timing sampling interval (rounded to power of 2)");
+        size_t n2 = 1;
+        while(n2 < size_t(std::max(i, 1))) n2 <<= 1;
+        return n2;
+    }();
+    return n;
+}
+
+_ProfilingSink::_ProfilingSink(const string& name): XMLProvider("StageProfile"), sampleMask(sampleEvery() - 1) {
+    S.name = name;
+    std::lock_guard<std::mutex> lk(regLock());
+    registry().push_back(this);
+}
+
+_ProfilingSink::~_ProfilingSink() {
+    std::lock_guard<std::mutex> lk(regLock());
+    auto& R = registry();
+    R.erase(std::remove(R.begin(), R.end(), this), R.end());
+}
+
+void _ProfilingSink::retire() {
+    std::lock_guard<std::mutex> lk(regLock());
+    auto& R = registry();
+    auto it = std::find(R.begin(), R.end(), this);
+    if(it == R.end()) return;
+    R.erase(it);
+    retired().push_back(stats());
+}
+
+void _ProfilingSink::clearRetired() {
+    std::lock_guard<std::mutex> lk(regLock());
+    retired().clear();
+}
+
+StageStats _ProfilingSink::stats() const {
+    StageStats s = S;
+    if(s.n_timed && s.n_timed < s.n_items) s.t_push *= double(s.n_items) / s.n_timed;
+    auto m = stageMetrics();
+    if(m) m->getStageMetrics(s);
+    return s;
+}
+
+void _ProfilingSink::_makeXML(XMLTag& X) {
+    auto s = stats();
+    X.addAttr("stage", s.name);
+    X.addAttr("n_items", s.n_items);
+    X.addAttr("t_push", s.t_push);
+    X.addAttr("n_signals", s.n_signals);
+    X.addAttr("t_signal", s.t_signal);
+    if(s.n_timed != s.n_items) X.addAttr("n_timed", s.n_timed);
+    if(s.queue_hwm) X.addAttr("queue_hwm", s.queue_hwm);
+    if(s.n_disordered) X.addAttr("n_disordered", s.n_disordered);
+    if(s.n_dropped) X.addAttr("n_dropped", s.n_dropped);
+}
+
+void _ProfilingSink::writeJSON(std::ostream& o) {
+    std::lock_guard<std::mutex> lk(regLock());
+    vector<StageStats> v;
+    for(auto P: registry()) v.push_back(P->stats());
+    v.insert(v.end(), retired().begin(), retired().end());
+
+    o << "{\"stages\": [";
+    bool first = true;
+    for(auto& s: v) {
+        o << (first? "\n  " : ",\n  ") << "{\"stage\": " << json_str(s.name)
+          << ", \"n_items\": " << s.n_items << ", \"n_timed\": " << s.n_timed
+          << ", \"t_push\": " << s.t_push << ", \"ns_per_item\": " << (s.n_items? 1e9 * s.t_push / s.n_items : 0.)
+          << ", \"n_signals\": " << s.n_signals << ", \"t_signal\": " << s.t_signal
+          << ", \"queue_hwm\": " << s.queue_hwm << ", \"n_disordered\": " << s.n_disordered << ", \"n_dropped\": " << s.n_dropped << "}";
+        first = false;
+    }
+    o << "\n]}\n";
+}
+
+vector<StageStats> _ProfilingSink::allStats() {
+    std::lock_guard<std::mutex> lk(regLock());
+    vector<StageStats> v;
+    for(auto P: registry()) v.push_back(P->stats());
+    v.insert(v.end(), retired().begin(), retired().end());
+    return v;
+}
+
+void _ProfilingSink::record_signal(datastream_signal_t s) {
+    ++S.n_signals;
+    if(s != DATASTREAM_END || ended || !reportOnEnd()) return;
+    ended = true;
+
+    // write summary once all profilers have ended (re-arming for any later run)
+    {
+        std::lock_guard<std::mutex> lk(regLock());
+        for(auto P: registry()) if(!P->ended) return;
+        for(auto P: registry()) P->ended = false;
+    }
+    static string fout = optionalGlobalDefault("profileJSON", "", "JSON pipeline profile output file (default: stdout)");
+    if(fout.size()) {
+        std::ofstream f(fout);
+        writeJSON(f);
+    } else writeJSON(std::cout);
+    clearRetired();
+}
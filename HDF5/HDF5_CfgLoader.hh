@@ -5,6 +5,7 @@
 
 #include "CfgLoader.hh"
 #include "HDF5_Table_Cache.hh"
+#include "ExplainConfig.hh"
 
 /// Scan generic data from HDF5 file
 template<typename T>
@@ -12,7 +13,13 @@ class HDF5_CfgLoader: public HDF5_Table_Cache<T>, public CfgLoader<T> {
 public:
     /// Constructor
     explicit HDF5_CfgLoader(const Setting& S, const string& farg = "", const string& tname = "", int v = 0):
-    XMLProvider("HDF5_CfgLoader"), HDF5_Table_Cache<T>(tname, v), CfgLoader<T>(S, farg) { }
+    XMLProvider("HDF5_CfgLoader"), HDF5_Table_Cache<T>(tname, v), CfgLoader<T>(S, farg) {
+        SettingsQuery Cfg(S);
+        Cfg.ignore_unused();    // remaining settings belong to CfgLoader
+        string gate;
+        if(Cfg.lookupValue("throttle", gate, "named backpressure gate pausing chunk reads"))
+            this->throttle = &BackpressureGate::named(gate);
+    }
 };
 
 /// Write generic data to HDF5 file
@@ -5,8 +5,14 @@
 #include "PathUtils.hh" // for makePath
 #include <climits>
 
+std::recursive_mutex& HDF5_mutex() {
+    static std::recursive_mutex m;
+    return m;
+}
+
 void HDF5_InputFile::openInput(const string& filename) {
     _FileSource::openInput(filename);
+    HDF5_Lock l;
     if(infile_id) {
         printf("Closing previous input file.\n");
         H5Fclose(infile_id);
@@ -25,6 +31,7 @@ void HDF5_OutputFile::openOutput(const string& filename) {
     makePath(filename, true);
     printf("Opening HDF5 output file '%s'.\n", filename.c_str());
     outfile_name = filename;
+    HDF5_Lock l;
     outfile_id = H5Fcreate(outfile_name.c_str(), // file name
                            H5F_ACC_TRUNC, // access_mode : overwrite old file with new data
                            H5P_DEFAULT,   // create_ID defaults
@@ -38,18 +45,21 @@ void HDF5_OutputFile::writeFile() {
         return;
     }
     printf("Writing data to HDF5 file '%s' and closing...\n", outfile_name.c_str());
+    HDF5_Lock l;
     H5Fclose(outfile_id);
     outfile_id = 0;
 }
 
 bool HDF5_InputFile::doesAttrExist(const string& objname, const string& attrname) const {
     if(!infile_id) throw std::runtime_error("Cannot read attribute without file");
+    HDF5_Lock l;
     auto res = H5Aexists_by_name(infile_id, objname.c_str(), attrname.c_str(), H5P_DEFAULT);
     if(res < 0) throw std::runtime_error("H5Aexists_by_name failed");
     return res;
 }
 
 string HDF5_InputFile::getAttribute(const string& table, const string& attrname, const string& dflt) const {
+    HDF5_Lock l;
     if(!doesAttrExist(table, attrname)) return dflt;
 
     hsize_t dims;
@@ -65,6 +75,7 @@ string HDF5_InputFile::getAttribute(const string& table, const string& attrname,
 }
 
 double HDF5_InputFile::getAttributeD(const string& table, const string& attrname, double dflt) const {
+    HDF5_Lock l;
     if(!doesAttrExist(table, attrname)) return dflt;
 
     double d = dflt;
@@ -77,6 +88,7 @@ hsize_t HDF5_InputFile::getTableEntries(const string& table, hsize_t* nfields) {
     if(nfields) *nfields = 0;
     if(!infile_id) return 0;
     hsize_t nf, nrecords;
+    HDF5_Lock l;
     herr_t err = H5TBget_table_info(infile_id, table.c_str(), nfields? nfields : &nf, &nrecords);
     if(err < 0) throw std::runtime_error("H5TBget_table_info error");
     return nrecords;
@@ -93,12 +105,14 @@ HDF5_OutputFile::~HDF5_OutputFile() {
 
 void HDF5_OutputFile::writeAttribute(const string& table, const string& attrname, double value) {
     if(!outfile_id) throw std::logic_error("Cannot write attribute " + table + ":" + attrname + " without file");
+    HDF5_Lock l;
     herr_t err = H5LTset_attribute_double(outfile_id, table.c_str(), attrname.c_str(), &value, 1);
     if(err < 0) throw std::runtime_error("H5LTset_attribute_double error setting attribute " + table + ":" + attrname);
 }
 
 void HDF5_OutputFile::writeAttribute(const string& table, const string& attrname, const string& value) {
     if(!outfile_id) throw std::logic_error("Cannot write attribute " + table + ":" + attrname + " without file");
+    HDF5_Lock l;
     herr_t err = H5LTset_attribute_string(outfile_id, table.c_str(), attrname.c_str(), value.c_str());
     if(err < 0) throw std::runtime_error("H5LTset_attribute_string error " + table + ":" + attrname);
 }
@@ -9,13 +9,22 @@
 #include <string>
 using std::string;
 #include <stdexcept>
+#include <mutex>
 #include "DataSource.hh"
 
+/// process-wide lock on HDF5 library, which is not thread-safe (e.g. for tables read in concurrent PrefetchingSource threads)
+std::recursive_mutex& HDF5_mutex();
+/// scoped hold of HDF5_mutex() around HDF5 library calls
+struct HDF5_Lock: public std::lock_guard<std::recursive_mutex> {
+    /// Constructor, acquiring lock
+    HDF5_Lock(): std::lock_guard<std::recursive_mutex>(HDF5_mutex()) { }
+};
+
 /// base class for HDF5 file input
 class HDF5_InputFile: virtual public _FileSource {
 public:
     /// Destructor
-    virtual ~HDF5_InputFile() { if(infile_id) H5Fclose(infile_id); }
+    virtual ~HDF5_InputFile() { if(infile_id) { HDF5_Lock l; H5Fclose(infile_id); } }
     /// Open named input file
     void openInput(const string& filename) override;
 
@@ -7,6 +7,7 @@
 #include "HDF5_IO.hh"
 #include "HDF5_StructInfo.hh"
 #include "DataSink.hh"
+#include "BackpressureGate.hh"
 #include <map>
 using std::map;
 using std::multimap;
@@ -28,6 +29,7 @@ public:
     { return HDF5_InputFile::getAttribute(Tspec.table_name, attrname, dflt); }
 
     HDF5_Table_Spec Tspec;      ///< configuration for table to read
+    BackpressureGate* throttle = nullptr;   ///< optional downstream backpressure gate, awaited before reading each chunk
 
 protected:
     size_t cache_idx = 0;       ///< index in cached data
@@ -54,6 +56,8 @@ public:
 
     /// get next table row; return whether successful or failed (end-of-file)
     bool next(T& val) override;
+    /// view of next (up to nmax) table rows directly from read cache
+    span_view<T> next_batch(size_t nmax) override;
     /// skip ahead number of entries
     bool skip(size_t n) override;
     /// Re-start at beginning of stream
@@ -62,10 +66,18 @@ public:
     /// Open named input file
     void openInput(const string& filename) override
     { _HDF5_Table_Cache::openInput(filename); setFile(infile_id); }
+    /// Start OS readahead of deferred input file (see deferInput()); opened on first read, under HDF5_mutex()
+    void prefetch() override { this->readahead(); }
     /// (re)set read file
     void setFile(hid_t f);
     /// Estimate remaining data size (no loop)
     size_t entries() const override { return nRows; }
+    /// save read position: rows consumed, excluding cached-but-unread rows and loadEvent look-ahead
+    void saveState(BinaryWriter& B) const override {
+        size_t n = nread - (cached.size() - cache_idx);
+        if(id_current_evt >= 0 && n) --n;
+        B.send(n);
+    }
     /// set identifying number for value type
     static void setIdentifier(T& i, int64_t n) { i.evt = n; }
 
@@ -73,6 +85,9 @@ public:
     int64_t loadEvent(vector<T>& v);
 
 protected:
+    /// ensure cache has unread data; return false at end of input
+    bool fillCache();
+
     T next_read{};              ///< next item read in for event list reads
     vector<T> cached;           ///< cached read data
 };
@@ -122,7 +137,9 @@ public:
     /// write table row
     void push(const T& val) override;
     /// write table rows
-    void push(const vector<T>& vals);
+    void push(const vector<T>& vals) { push_batch(vals); }
+    /// write batch of table rows
+    void push_batch(typename DataSink<const T>::span_t v) override;
     /// accept data flow signal
     void signal(datastream_signal_t sig) override;
 
@@ -154,10 +171,17 @@ public:
 ///////////////////////////////////////////////
 
 template<typename T>
-void HDF5_Table_Writer<T>::push(const vector<T>& vals) {
-    cached.insert(cached.end(), vals.begin(), vals.end());
+void HDF5_Table_Writer<T>::push_batch(typename DataSink<const T>::span_t v) {
+    nwrite += v.size();
+    if(!cached.size() && v.size() >= nchunk && outfile_id) { // write directly, skipping cache copy
+        HDF5_Lock l;
+        herr_t err = H5TBappend_records(outfile_id,  Tspec.table_name.c_str(), v.size(),
+                                        sizeof(T),  Tspec.offsets, Tspec.field_sizes, v.data());
+        if(err < 0) throw std::runtime_error("Failed to append records to HDF5 table '" + Tspec.table_name + "'");
+        return;
+    }
+    cached.insert(cached.end(), v.begin(), v.end());
     if(cached.size() >= nchunk) flush_cached();
-    nwrite += vals.size();
 }
 
 template<typename T>
@@ -181,6 +205,7 @@ void HDF5_Table_Writer<T>::signal(datastream_signal_t sig) {
 template<typename T>
 void HDF5_Table_Writer<T>::flush_cached() {
     if(outfile_id && cached.size()) {
+        HDF5_Lock l;
         herr_t err = H5TBappend_records(outfile_id,  Tspec.table_name.c_str(), cached.size(),
                                         sizeof(T),  Tspec.offsets, Tspec.field_sizes, cached.data());
         if(err < 0) throw std::runtime_error("Failed to append records to HDF5 table '" + Tspec.table_name + "'");
@@ -194,6 +219,7 @@ void HDF5_Table_Writer<T>::flush_cached() {
 
 template<typename T>
 void HDF5_Table_Cache<T>::setFile(hid_t f) {
+    HDF5_Lock l;
     infile_id = f;
     cached.clear();
     cache_idx = nread = nRows = 0;
@@ -210,7 +236,11 @@ void HDF5_Table_Cache<T>::setFile(hid_t f) {
 }
 
 template<typename T>
-bool HDF5_Table_Cache<T>::next(T& val) {
+bool HDF5_Table_Cache<T>::fillCache() {
+    if(!infile_id) {
+        HDF5_Lock l;
+        this->openDeferred();
+    }
     if(!infile_id) return false;
 
     if(cache_idx >= cached.size()) { // cache exhausted, needs new data
@@ -223,19 +253,35 @@ bool HDF5_Table_Cache<T>::next(T& val) {
 
         hsize_t nToRead = std::min(nchunk, hsize_t(this->entries_remaining()));
         if(!nToRead) return false;
+        if(throttle) throttle->wait_open();
 
         cached.resize(nToRead);
         cache_idx = 0;
+        HDF5_Lock l;
         herr_t err = H5TBread_records(infile_id, Tspec.table_name.c_str(), nread, nToRead,
                                       sizeof(T),  Tspec.offsets, Tspec.field_sizes, cached.data());
         if(err < 0) throw std::runtime_error("Unexpected failure reading HDF5 file");
         nread += nToRead;
     }
+    return true;
+}
 
+template<typename T>
+bool HDF5_Table_Cache<T>::next(T& val) {
+    if(!fillCache()) return false;
     val = cached.at(cache_idx++);
     return true;
 }
 
+template<typename T>
+span_view<T> HDF5_Table_Cache<T>::next_batch(size_t nmax) {
+    if(!fillCache()) return {};
+    size_t n = std::min(nmax, cached.size() - cache_idx);
+    span_view<T> v(cached.data() + cache_idx, n);
+    cache_idx += n;
+    return v;
+}
+
 template<typename T>
 bool HDF5_Table_Cache<T>::skip(size_t n) {
     if(!n) return true;
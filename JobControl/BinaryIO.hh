@@ -13,7 +13,10 @@ using std::vector;
 #include <map>
 using std::map;
 #include <cstring> // for std::memcpy
+#include <cstdint>
+#include <cstddef>
 #include <stdexcept>
+#include "span_view.hh"
 
 // workaround for older gcc without std::is_trivially_copyable
 #if __GNUG__ && __GNUC__ < 5
@@ -22,6 +25,10 @@ using std::map;
 #define IS_TRIVIALLY_COPYABLE(T) std::is_trivially_copyable<T>::value
 #endif
 
+/// whether T is serialized as its raw bytes, so contiguous arrays of T can be transferred in bulk
+template<typename T>
+struct is_bulk_copyable: std::integral_constant<bool, IS_TRIVIALLY_COPYABLE(T) && !std::is_pointer<T>::value && !std::is_same<T,bool>::value> { };
+
 /// Base binary class receiving input with serializer functions
 class BinaryWriter {
 public:
@@ -74,7 +81,7 @@ public:
     void send(const vector<T>& v) {
         start_wtx();
         send<int>(v.size()*sizeof(T));
-        for(const auto& x: v) send(x);
+        send_elements(v, is_bulk_copyable<T>());
         end_wtx();
     }
 
@@ -83,6 +90,7 @@ public:
     void send(const map<K,V>& mp) {
         start_wtx();
         send<size_t>(mp.size());
+        if(is_bulk_copyable<K>::value && is_bulk_copyable<V>::value) wbuff.reserve(wbuff.size() + mp.size()*(sizeof(K) + sizeof(V)));
         for(const auto& kt: mp) {
             send(kt.first);
             send(kt.second);
@@ -100,6 +108,13 @@ protected:
     /// append data block to write buffer
     void append_write(const char* dat, size_t n);
 
+    /// bulk send of contiguous raw-bytes elements
+    template<typename T>
+    void send_elements(const vector<T>& v, std::true_type) { append_write(reinterpret_cast<const char*>(v.data()), v.size()*sizeof(T)); }
+    /// element-by-element send
+    template<typename T>
+    void send_elements(const vector<T>& v, std::false_type) { for(const auto& x: v) send(x); }
+
     int dataDest = 0;       ///< destination identifier for data send
     size_t wtxdepth = 0;    ///< write transaction depth counter
     vector<char> wbuff;     ///< deferred write buffer
@@ -159,18 +174,30 @@ public:
     template<typename T>
     void receive(vector<T>& v) {
         v.resize(receive<int>()/sizeof(T));
-        for(auto& x: v) receive(x);
+        receive_elements(v, is_bulk_copyable<T>());
     }
 
     /// map data receive
     template<typename K, typename V>
     void receive(map<K,V>& mp) {
         mp.clear();
-        auto n = receive<size_t>();
-        while(n--) {
-            auto k = receive<K>();
-            mp.emplace(k, receive<V>());
+        receive_entries(mp, receive<size_t>(), std::integral_constant<bool, is_bulk_copyable<K>::value && is_bulk_copyable<V>::value>());
+    }
+
+    /// View of vector<T> data (as sent by BinaryWriter), without copying when reader buffers it in memory at suitable alignment;
+    /// otherwise copied to an internal buffer. Valid until the next read.
+    template<typename T>
+    span_view<const T> receive_view() {
+        static_assert(is_bulk_copyable<T>::value, "View requires raw-bytes element type");
+        size_t n = receive<int>();
+        auto p = read_view(n);
+        if(!p || reinterpret_cast<uintptr_t>(p) % alignof(T)) {
+            viewbuf.resize((n + sizeof(std::max_align_t) - 1)/sizeof(std::max_align_t));
+            if(p) std::memcpy(viewbuf.data(), p, n);
+            else read(viewbuf.data(), n);
+            p = reinterpret_cast<const char*>(viewbuf.data());
         }
+        return span_view<const T>(reinterpret_cast<const T*>(p), n/sizeof(T));
     }
 
     /// raw blocking data receive; error if full read not achieved
@@ -179,9 +206,41 @@ public:
     virtual size_t read_upto(void*, size_t) { return 0; }
     /// skip over n bytes (... please reimplement faster!)
     virtual void ignore(size_t n) { vector<char> foo(n); read(foo.data(), n); }
+    /// in-place view of next n bytes, valid until next read, advancing read position; nullptr (without reading) if unsupported
+    virtual const char* read_view(size_t) { return nullptr; }
 
 protected:
     int dataSrc = 0;    ///< source identifier for data receive
+    vector<std::max_align_t> viewbuf;   ///< aligned copy buffer for receive_view
+
+    /// bulk receive of contiguous raw-bytes elements
+    template<typename T>
+    void receive_elements(vector<T>& v, std::true_type) { if(v.size()) read(v.data(), v.size()*sizeof(T)); }
+    /// element-by-element receive
+    template<typename T>
+    void receive_elements(vector<T>& v, std::false_type) { for(auto& x: v) receive(x); }
+
+    /// receive n raw-bytes map entries in one read
+    template<typename K, typename V>
+    void receive_entries(map<K,V>& mp, size_t n, std::true_type) {
+        vector<char> b(n*(sizeof(K) + sizeof(V)));
+        if(n) read(b.data(), b.size());
+        K k;
+        V x;
+        for(auto p = b.data(); n--; p += sizeof(K) + sizeof(V)) {
+            std::memcpy(&k, p, sizeof(K));
+            std::memcpy(&x, p + sizeof(K), sizeof(V));
+            mp.emplace_hint(mp.end(), k, x);
+        }
+    }
+    /// receive n map entries one at a time
+    template<typename K, typename V>
+    void receive_entries(map<K,V>& mp, size_t n, std::false_type) {
+        while(n--) {
+            auto k = receive<K>();
+            mp.emplace_hint(mp.end(), k, receive<V>());
+        }
+    }
 
 };
 
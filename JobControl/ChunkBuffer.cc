@@ -0,0 +1,95 @@
+/// @file ChunkBuffer.cc
+
+#include "ChunkBuffer.hh"
+#include <cstring>
+#include <algorithm>
+
+constexpr size_t ChunkBuffer::max_spare;
+
+void ChunkBuffer::clear() {
+    while(chunks.size()) pop_chunk();
+    nbytes = 0;
+}
+
+ChunkBuffer::chunk_t& ChunkBuffer::new_chunk(size_t n) {
+    chunks.emplace_back();
+    auto& c = chunks.back();
+    n = std::max(n, chunksize);
+    if(spare.size() && spare.back().size() >= n) {
+        std::swap(c.d, spare.back());
+        spare.pop_back();
+    } else c.d.resize(n);
+    return c;
+}
+
+void ChunkBuffer::pop_chunk() {
+    auto& c = chunks.front();
+    if(spare.size() < max_spare && c.d.size() == chunksize) spare.push_back(std::move(c.d));
+    chunks.pop_front();
+}
+
+void ChunkBuffer::append(const void* p, size_t n) {
+    auto v = static_cast<const char*>(p);
+    nbytes += n;
+    while(n) {
+        auto& c = chunks.size() && chunks.back().w < chunks.back().d.size()? chunks.back() : new_chunk(n);
+        auto m = std::min(n, c.d.size() - c.w);
+        std::memcpy(c.d.data() + c.w, v, m);
+        c.w += m;
+        v += m;
+        n -= m;
+    }
+}
+
+size_t ChunkBuffer::consume(void* p, size_t n) {
+    auto v = static_cast<char*>(p);
+    n = std::min(n, nbytes);
+    nbytes -= n;
+    auto n0 = n;
+    while(n) {
+        auto& c = chunks.front();
+        auto m = std::min(n, c.w - c.r);
+        std::memcpy(v, c.d.data() + c.r, m);
+        c.r += m;
+        v += m;
+        n -= m;
+        if(c.r == c.w) pop_chunk();
+    }
+    return n0;
+}
+
+size_t ChunkBuffer::discard(size_t n) {
+    n = std::min(n, nbytes);
+    nbytes -= n;
+    auto n0 = n;
+    while(n) {
+        auto& c = chunks.front();
+        auto m = std::min(n, c.w - c.r);
+        c.r += m;
+        n -= m;
+        if(c.r == c.w) pop_chunk();
+    }
+    return n0;
+}
+
+const char* ChunkBuffer::consume_view(size_t n) {
+    if(!n || chunks.empty()) return nullptr;
+    auto& c = chunks.front();
+    if(c.w - c.r < n) return nullptr;
+    auto p = c.d.data() + c.r;
+    c.r += n;
+    nbytes -= n;
+    // keep exhausted chunk until next operation, so view stays valid
+    return p;
+}
+
+std::pair<char*, size_t> ChunkBuffer::write_space(size_t nmin) {
+    if(chunks.empty() || chunks.back().d.size() - chunks.back().w < nmin) new_chunk(nmin);
+    auto& c = chunks.back();
+    return {c.d.data() + c.w, c.d.size() - c.w};
+}
+
+void ChunkBuffer::commit_write(size_t n) {
+    chunks.back().w += n;
+    nbytes += n;
+}
@@ -0,0 +1,67 @@
+/// @file ChunkBuffer.hh Chunk-linked FIFO byte buffer with bulk append/consume
+
+#ifndef CHUNKBUFFER_HH
+#define CHUNKBUFFER_HH
+
+#include <vector>
+using std::vector;
+#include <deque>
+#include <utility>
+#include <cstddef>
+
+/// FIFO byte buffer stored as a queue of fixed-size chunks, recycled as consumed
+///
+/// Appends and consumes are memcpy per chunk touched, never per byte.
+/// Contents may be visited in place as (pointer, length) segments for gather I/O,
+/// and free tail space exposed for scatter input directly into the buffer.
+class ChunkBuffer {
+public:
+    /// Constructor, with chunk size
+    explicit ChunkBuffer(size_t cs = 1 << 16): chunksize(cs) { }
+
+    /// number of bytes buffered
+    size_t size() const { return nbytes; }
+    /// check if empty
+    bool empty() const { return !nbytes; }
+    /// discard all contents
+    void clear();
+
+    /// append n bytes
+    void append(const void* p, size_t n);
+    /// remove up to n bytes from front into p; return number removed
+    size_t consume(void* p, size_t n);
+    /// discard up to n bytes from front; return number discarded
+    size_t discard(size_t n);
+    /// pointer to next n bytes if contiguous in one chunk, then consumed (valid until next consume/discard); nullptr (without consuming) if not
+    const char* consume_view(size_t n);
+
+    /// writable contiguous space at end, at least nmin bytes; fill, then commit_write
+    std::pair<char*, size_t> write_space(size_t nmin = 1);
+    /// mark n bytes written into write_space as buffered
+    void commit_write(size_t n);
+
+    /// gather access: call f(const char* p, size_t n) for each contiguous segment, in order
+    template<typename F>
+    void for_each_segment(F f) const { for(auto& c: chunks) if(c.w > c.r) f(c.d.data() + c.r, c.w - c.r); }
+
+protected:
+    /// one buffer chunk
+    struct chunk_t {
+        vector<char> d; ///< chunk storage
+        size_t r = 0;   ///< read position
+        size_t w = 0;   ///< write position
+    };
+
+    /// add new (recycled if possible) chunk of at least n bytes at end
+    chunk_t& new_chunk(size_t n);
+    /// drop consumed chunk at front
+    void pop_chunk();
+
+    size_t chunksize;               ///< default chunk allocation size
+    size_t nbytes = 0;              ///< total buffered bytes
+    std::deque<chunk_t> chunks;     ///< buffered chunks
+    vector<vector<char>> spare;     ///< recycled chunk storage
+    static constexpr size_t max_spare = 8;  ///< maximum number of recycled chunks retained
+};
+
+#endif
@@ -0,0 +1,310 @@
+/// @file CompressedBIO.cc
+
+#include "CompressedBIO.hh"
+#include "zlibWrapper.hh"
+#include <algorithm>
+#include <cstdio>
+
+CompressedBWriter::CompressedBWriter(BinaryWriter& _W, size_t bsize, bool background):
+W(_W), blocksize(bsize) {
+    if(!blocksize || blocksize > UINT32_MAX) throw std::logic_error("Invalid compressed block size");
+    cur.reserve(blocksize);
+    if(!background) return;
+
+    running = true;
+    compressor = std::thread([this] {
+        std::unique_lock<std::mutex> lk(qMut);
+        while(true) {
+            qCond.wait(lk, [this] { return queued.size() || !running; });
+            if(queued.empty()) return;
+            auto b = std::move(queued.front());
+            queued.pop_front();
+            busy = true;
+            lk.unlock();
+            qCond.notify_all();
+
+            std::exception_ptr e;
+            try { write_block(b); }
+            catch(...) { e = std::current_exception(); }
+
+            lk.lock();
+            if(e && !err) err = e;
+            busy = false;
+            qCond.notify_all();
+        }
+    });
+}
+
+CompressedBWriter::~CompressedBWriter() {
+    try { close(); }
+    catch(std::exception& e) { fprintf(stderr, "\n*** ERROR: CompressedBWriter close in destructor failed: %s\n", e.what()); }
+    catch(...) { fprintf(stderr, "\n*** ERROR: CompressedBWriter close in destructor failed\n"); }
+}
+
+void CompressedBWriter::_send(const void* vptr, size_t size) {
+    if(closed) throw std::logic_error("Write to closed compressed stream");
+    auto v = static_cast<const char*>(vptr);
+    n_raw += size;
+    while(size) {
+        auto n = std::min(size, blocksize - cur.size());
+        cur.insert(cur.end(), v, v + n);
+        v += n;
+        size -= n;
+        if(cur.size() == blocksize) submit_block();
+    }
+}
+
+void CompressedBWriter::submit_block() {
+    if(cur.empty()) return;
+    if(!compressor.joinable()) write_block(cur);
+    else {
+        std::unique_lock<std::mutex> lk(qMut);
+        qCond.wait(lk, [this] { return queued.size() < maxQueued || err; });
+        if(err) { auto e = err; err = nullptr; std::rethrow_exception(e); }
+        queued.push_back(std::move(cur));
+        lk.unlock();
+        qCond.notify_all();
+        cur = vector<char>();
+    }
+    cur.clear();
+    cur.reserve(blocksize);
+}
+
+void CompressedBWriter::write_block(const vector<char>& b) {
+    vector<char> z;
+    deflate(b.data(), b.size(), z, level);
+    bool stored = z.size() >= b.size();
+    zblock_frame_t h{ZBLOCK_DATA, uint32_t(b.size()), uint32_t(stored? b.size() : z.size())};
+
+    index.push_back({raw_indexed, n_comp});
+    raw_indexed += b.size();
+
+    W.start_wtx();
+    W.send(h);
+    W.send(stored? b.data() : z.data(), h.ncomp);
+    W.end_wtx();
+    n_comp += sizeof(h) + h.ncomp;
+}
+
+void CompressedBWriter::wait_idle() {
+    if(!compressor.joinable()) return;
+    std::unique_lock<std::mutex> lk(qMut);
+    qCond.wait(lk, [this] { return (queued.empty() && !busy) || err; });
+    if(err) { auto e = err; err = nullptr; std::rethrow_exception(e); }
+}
+
+void CompressedBWriter::sync() {
+    submit_block();
+    wait_idle();
+}
+
+void CompressedBWriter::close() {
+    if(closed) return;
+    closed = true;
+
+    std::exception_ptr e;
+    try { sync(); }
+    catch(...) { e = std::current_exception(); }
+    if(compressor.joinable()) {
+        {
+            std::lock_guard<std::mutex> lk(qMut);
+            running = false;
+        }
+        qCond.notify_all();
+        compressor.join();
+    }
+    if(e) std::rethrow_exception(e);
+
+    zblock_trailer_t t{n_comp, n_raw, uint32_t(index.size()), ZBLOCK_TRAILER};
+    zblock_frame_t h{ZBLOCK_INDEX, uint32_t(index.size()), uint32_t(index.size() * sizeof(zblock_index_t))};
+    W.start_wtx();
+    W.send(h);
+    if(index.size()) W.send(index.data(), h.ncomp);
+    W.send(t);
+    W.end_wtx();
+    n_comp += sizeof(h) + h.ncomp + sizeof(t);
+}
+
+//--------------------------------------------
+
+CompressedBReader::CompressedBReader(const void* p, size_t n): dZ(static_cast<const char*>(p)), nZ(n) {
+    zblock_trailer_t t;
+    if(nZ < sizeof(t)) throw std::runtime_error("Compressed stream too short for trailer");
+    std::memcpy(&t, dZ + nZ - sizeof(t), sizeof(t));
+    if(t.magic != ZBLOCK_TRAILER) throw std::runtime_error("Compressed stream trailer not found");
+
+    zblock_frame_t h;
+    if(t.indexpos + sizeof(h) + sizeof(t) > nZ) throw std::runtime_error("Corrupt compressed stream index location");
+    std::memcpy(&h, dZ + t.indexpos, sizeof(h));
+    if(h.magic != ZBLOCK_INDEX || h.nraw != t.nblocks || size_t(h.ncomp) != t.nblocks * sizeof(zblock_index_t)
+        || t.indexpos + sizeof(h) + h.ncomp + sizeof(t) != nZ) throw std::runtime_error("Corrupt compressed stream index");
+    index.resize(t.nblocks);
+    if(index.size()) std::memcpy(index.data(), dZ + t.indexpos + sizeof(h), h.ncomp);
+    rawsize = t.rawsize;
+}
+
+void CompressedBReader::decode(const zblock_frame_t& h, const char* z, vector<char>& out) {
+    out.resize(h.nraw);
+    if(h.ncomp == h.nraw) std::memcpy(out.data(), z, h.nraw);
+    else if(inflate(z, h.ncomp, out.data(), h.nraw) != h.nraw) throw std::runtime_error("Compressed block decompression failed");
+}
+
+const char* CompressedBReader::frame_at(size_t i, zblock_frame_t& h) const {
+    auto p = index.at(i).framepos;
+    if(p + sizeof(h) > nZ) throw std::runtime_error("Corrupt compressed block index");
+    std::memcpy(&h, dZ + p, sizeof(h));
+    if(h.magic != ZBLOCK_DATA || p + sizeof(h) + h.ncomp > nZ) throw std::runtime_error("Corrupt compressed block");
+    return dZ + p + sizeof(h);
+}
+
+bool CompressedBReader::next_block() {
+    bpos = 0;
+    buf.clear();
+
+    if(!R) {
+        if(nextblock >= index.size()) return false;
+        if(nahead) take_ahead();
+        else {
+            zblock_frame_t h;
+            auto z = frame_at(nextblock, h);
+            decode(h, z, buf);
+        }
+        ++nextblock;
+        return true;
+    }
+
+    if(ended) return false;
+    zblock_frame_t h;
+    R->read(&h, sizeof(h));
+    if(h.magic == ZBLOCK_INDEX) {
+        R->ignore(h.ncomp + sizeof(zblock_trailer_t));
+        ended = true;
+        return false;
+    }
+    if(h.magic != ZBLOCK_DATA) throw std::runtime_error("Corrupt compressed stream");
+    zbuf.resize(h.ncomp);
+    R->read(zbuf.data(), h.ncomp);
+    decode(h, zbuf.data(), buf);
+    return true;
+}
+
+void CompressedBReader::read(void* vptr, size_t size) {
+    auto v = static_cast<char*>(vptr);
+    while(size) {
+        if(bpos == buf.size() && !next_block()) throw std::runtime_error("Compressed stream out of data");
+        auto n = std::min(size, buf.size() - bpos);
+        std::memcpy(v, buf.data() + bpos, n);
+        bpos += n;
+        v += n;
+        size -= n;
+    }
+}
+
+size_t CompressedBReader::read_upto(void* vptr, size_t size) {
+    if(bpos == buf.size() && !next_block()) return 0;
+    size = std::min(size, buf.size() - bpos);
+    std::memcpy(vptr, buf.data() + bpos, size);
+    bpos += size;
+    return size;
+}
+
+const char* CompressedBReader::read_view(size_t n) {
+    if(bpos == buf.size() && n && !next_block()) throw std::runtime_error("Compressed stream out of data");
+    if(bpos + n > buf.size()) return nullptr;
+    auto p = buf.data() + bpos;
+    bpos += n;
+    return p;
+}
+
+void CompressedBReader::seek(size_t pos) {
+    if(R) throw std::logic_error("Seek requires random-access compressed stream");
+    if(pos > rawsize) throw std::range_error("Seek past end of compressed stream");
+    auto it = std::upper_bound(index.begin(), index.end(), pos,
+                               [](size_t p, const zblock_index_t& b) { return p < b.rawpos; });
+    nextblock = it - index.begin();
+    buf.clear();
+    bpos = 0;
+    if(nextblock) --nextblock;
+    restart_ahead();
+    if(it == index.begin()) return;
+    next_block();
+    bpos = pos - index[nextblock - 1].rawpos;
+}
+
+void CompressedBReader::prefetch(unsigned int nthreads, size_t nblocks) {
+    if(R) throw std::logic_error("Prefetch requires random-access compressed stream");
+    stop_prefetch();
+    if(!nthreads) nthreads = std::max(std::thread::hardware_concurrency(), 1U);
+    nahead = nblocks? nblocks : 2 * nthreads;
+    restart_ahead();
+    ahead_stop = false;
+    for(unsigned int t = 0; t < nthreads; ++t) decoders.emplace_back(&CompressedBReader::ahead_job, this);
+}
+
+void CompressedBReader::stop_prefetch() {
+    {
+        std::lock_guard<std::mutex> lk(aMut);
+        ahead_stop = true;
+    }
+    aCond.notify_all();
+    for(auto& t: decoders) t.join();
+    decoders.clear();
+    ahead.clear();
+    nahead = 0;
+}
+
+void CompressedBReader::restart_ahead() {
+    if(!nahead) return;
+    std::lock_guard<std::mutex> lk(aMut);
+    ++ahead_gen;
+    ahead.clear();
+    ahead_base = nextblock;
+    while(ahead_base + ahead.size() < index.size() && ahead.size() < nahead) ahead.emplace_back();
+    aCond.notify_all();
+}
+
+void CompressedBReader::take_ahead() {
+    std::unique_lock<std::mutex> lk(aMut);
+    aCond.wait(lk, [this] { return ahead.front().state == 2; });
+    auto a = std::move(ahead.front());
+    ahead.pop_front();
+    if(++ahead_base + ahead.size() < index.size()) ahead.emplace_back();
+    lk.unlock();
+    aCond.notify_all();
+
+    if(a.e) std::rethrow_exception(a.e);
+    buf = std::move(a.d);
+}
+
+void CompressedBReader::ahead_job() {
+    std::unique_lock<std::mutex> lk(aMut);
+    while(true) {
+        size_t j = 0;
+        aCond.wait(lk, [this, &j] {
+            if(ahead_stop) return true;
+            for(j = 0; j < ahead.size(); ++j) if(!ahead[j].state) return true;
+            return false;
+        });
+        if(ahead_stop) return;
+
+        ahead[j].state = 1;
+        size_t i = ahead_base + j;
+        auto gen = ahead_gen;
+        lk.unlock();
+
+        ahead_t a;
+        try {
+            zblock_frame_t h;
+            auto z = frame_at(i, h);
+            decode(h, z, a.d);
+        } catch(...) { a.e = std::current_exception(); }
+
+        lk.lock();
+        if(gen != ahead_gen) continue;  // window restarted meanwhile
+        auto& b = ahead[i - ahead_base];
+        b.d = std::move(a.d);
+        b.e = a.e;
+        b.state = 2;
+        aCond.notify_all();
+    }
+}
@@ -0,0 +1,169 @@
+/// @file CompressedBIO.hh Block-compressed stream layer over any BinaryWriter/BinaryReader
+
+#ifndef COMPRESSEDBIO_HH
+#define COMPRESSEDBIO_HH
+
+#include "BinaryIO.hh"
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <exception>
+
+/*
+ * Stream format: sequence of independently zlib-compressed blocks, each framed by a zblock_frame_t header
+ * (stored uncompressed if compression does not shrink it); then an index frame listing each block's
+ * uncompressed and stream positions; then a fixed-size zblock_trailer_t locating the index.
+ * Sequential readers stop at the index frame; readers with the whole stream in memory (e.g. memory-mapped)
+ * use the trailer and index to seek and to decompress blocks in parallel.
+ */
+
+/// compressed stream frame header
+struct zblock_frame_t {
+    uint32_t magic;     ///< ZBLOCK_DATA or ZBLOCK_INDEX
+    uint32_t nraw;      ///< uncompressed size (or number of index entries)
+    uint32_t ncomp;     ///< compressed payload size (equal to nraw if stored uncompressed)
+};
+
+/// block index entry
+struct zblock_index_t {
+    uint64_t rawpos;    ///< uncompressed stream position of block start
+    uint64_t framepos;  ///< compressed stream position of block frame header
+};
+
+/// compressed stream trailer
+struct zblock_trailer_t {
+    uint64_t indexpos;  ///< compressed stream position of index frame header
+    uint64_t rawsize;   ///< total uncompressed size
+    uint32_t nblocks;   ///< number of data blocks
+    uint32_t magic;     ///< ZBLOCK_TRAILER
+};
+
+/// compressed stream frame identifiers
+enum zblock_magic_t {
+    ZBLOCK_DATA = 0x4b4c425a,       ///< "ZBLK" data block
+    ZBLOCK_INDEX = 0x5844495a,      ///< "ZIDX" block index
+    ZBLOCK_TRAILER = 0x4c52545a     ///< "ZTRL" stream trailer
+};
+
+/// Block-compressing BinaryWriter, framing compressed blocks onto another BinaryWriter
+///
+/// Blocks are compressed and written on a background thread (unless disabled), so the wrapped
+/// writer must not be used directly until close(). Each frame is sent as one write transaction.
+class CompressedBWriter: public BinaryWriter {
+public:
+    /// Constructor, wrapping output writer
+    explicit CompressedBWriter(BinaryWriter& _W, size_t bsize = 1 << 18, bool background = true);
+    /// Destructor, closing stream; errors are reported, not thrown (call close() to catch them)
+    ~CompressedBWriter();
+
+    /// compress and write out current partial block, waiting for completion
+    void sync();
+    /// write out remaining data, block index, and trailer; idempotent
+    void close();
+
+    int level = 1;          ///< zlib compression level (set before writing)
+    size_t n_raw = 0;       ///< uncompressed bytes written
+    size_t n_comp = 0;      ///< compressed stream bytes written (up to date after sync/close)
+
+protected:
+    /// accumulate data into blocks
+    void _send(const void* vptr, size_t size) override;
+
+    /// hand current block to compressor
+    void submit_block();
+    /// compress and write one block
+    void write_block(const vector<char>& b);
+    /// wait for queued blocks to finish; rethrow any compressor error
+    void wait_idle();
+
+    BinaryWriter& W;                ///< wrapped output
+    size_t blocksize;               ///< uncompressed block size
+    vector<char> cur;               ///< block being filled
+    vector<zblock_index_t> index;   ///< written block index
+    uint64_t raw_indexed = 0;       ///< uncompressed bytes in written blocks
+    bool closed = false;            ///< whether stream has been closed
+
+    std::thread compressor;         ///< background compression thread
+    std::mutex qMut;                ///< protects queue and compressor state
+    std::condition_variable qCond;  ///< queue change notification
+    std::deque<vector<char>> queued;    ///< blocks waiting for compression
+    size_t maxQueued = 4;           ///< maximum queued blocks before producer waits
+    bool busy = false;              ///< whether compressor is mid-block
+    bool running = false;           ///< compressor continuation flag
+    std::exception_ptr err;         ///< error caught on compressor thread
+};
+
+/// Reader for block-compressed stream, either sequentially from another BinaryReader or random-access in memory
+class CompressedBReader: public BinaryReader {
+public:
+    /// Constructor for sequential read from wrapped reader
+    explicit CompressedBReader(BinaryReader& _R): R(&_R) { }
+    /// Constructor for random access to complete compressed stream in memory (e.g. from MMapBReader::read_view)
+    CompressedBReader(const void* p, size_t n);
+    /// Destructor, stopping read-ahead threads
+    ~CompressedBReader() { stop_prefetch(); }
+
+    /// blocking data receive
+    void read(void* vptr, size_t size) override;
+    /// opportunistic data receive, up to end of current block
+    size_t read_upto(void* vptr, size_t size) override;
+    /// in-place view of next n bytes, if within current block
+    const char* read_view(size_t n) override;
+
+    /// total uncompressed size (random access only)
+    size_t rawSize() const { return rawsize; }
+    /// seek to uncompressed stream position (random access only)
+    void seek(size_t pos);
+    /// decompress blocks in background on nthreads (0 for hardware concurrency), up to nahead (0 for 2 per thread)
+    /// blocks ahead of the read position; the window advances as blocks are consumed (random access only)
+    void prefetch(unsigned int nthreads = 0, size_t nahead = 0);
+    /// stop background read-ahead
+    void stop_prefetch();
+    /// block index (random access only)
+    const vector<zblock_index_t>& blockIndex() const { return index; }
+
+protected:
+    /// load next block into buf; false at end of stream
+    bool next_block();
+    /// decompress frame payload into output buffer
+    static void decode(const zblock_frame_t& h, const char* z, vector<char>& out);
+    /// frame header and payload for indexed block i
+    const char* frame_at(size_t i, zblock_frame_t& h) const;
+    /// take next block from read-ahead window into buf, topping up window
+    void take_ahead();
+    /// restart read-ahead window at nextblock
+    void restart_ahead();
+    /// background read-ahead decompression loop
+    void ahead_job();
+
+    BinaryReader* R = nullptr;      ///< wrapped sequential reader, if not random access
+    bool ended = false;             ///< whether sequential stream end reached
+    vector<char> zbuf;              ///< sequential-read compressed payload buffer
+
+    const char* dZ = nullptr;       ///< random-access compressed stream
+    size_t nZ = 0;                  ///< random-access compressed stream size
+    size_t rawsize = 0;             ///< random-access uncompressed size
+    vector<zblock_index_t> index;   ///< random-access block index
+    size_t nextblock = 0;           ///< random-access next block to load
+
+    /// read-ahead block slot
+    struct ahead_t {
+        vector<char> d;             ///< decompressed block
+        std::exception_ptr e;       ///< decompression error
+        int state = 0;              ///< 0 waiting, 1 decoding, 2 done
+    };
+    std::deque<ahead_t> ahead;      ///< read-ahead window, for blocks starting at ahead_base
+    size_t ahead_base = 0;          ///< block number of read-ahead window start
+    size_t nahead = 0;              ///< read-ahead window size [blocks]; 0 when not prefetching
+    size_t ahead_gen = 0;           ///< window generation, advanced on restart (e.g. seek)
+    bool ahead_stop = false;        ///< read-ahead threads stop flag
+    vector<std::thread> decoders;   ///< read-ahead decompression threads
+    std::mutex aMut;                ///< protects read-ahead window
+    std::condition_variable aCond;  ///< read-ahead window change notification
+
+    vector<char> buf;               ///< current decompressed block
+    size_t bpos = 0;                ///< read position in current block
+};
+
+#endif
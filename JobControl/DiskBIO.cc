@@ -2,11 +2,148 @@
 
 #include "DiskBIO.hh"
 #include <sys/types.h>
+#include <sys/uio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <fcntl.h>
+#include <climits>
+#include <algorithm>
+#include <cstdio>
+
+FDBinaryWriter::~FDBinaryWriter() {
+    try { closeOut(); }
+    catch(std::exception& e) { fprintf(stderr, "\n*** ERROR: FDBinaryWriter close in destructor failed: %s\n", e.what()); }
+    catch(...) { fprintf(stderr, "\n*** ERROR: FDBinaryWriter close in destructor failed\n"); }
+}
+
+void FDBinaryWriter::setDurability(durability_t d, double interval, size_t nbytes) {
+    commit(false);
+    std::lock_guard<std::mutex> lb(bufMut);
+    durability = d;
+    sync_interval = interval;
+    sync_bytes = nbytes;
+}
 
 void FDBinaryWriter::_send(const void* vptr, size_t size) {
     if(!vptr || fOut < 0) throw std::logic_error("invalid object write");
-    if(size != (size_t)write(fOut, vptr, size)) throw std::runtime_error("Can't write file");
+
+    if(durability == DURABLE_STRICT) {
+        if(size != (size_t)write(fOut, vptr, size)) throw std::runtime_error("Can't write file");
+        ++n_writes;
+        std::lock_guard<std::mutex> lb(bufMut);
+        nunsynced += size;
+        return;
+    }
+
+    auto p = static_cast<const char*>(vptr);
+    std::lock_guard<std::mutex> lb(bufMut);
+    nbuffered += size;
+    if(size >= blocksize) { blocks.emplace_back(p, p + size); return; }
+    if(blocks.empty() || blocks.back().size() + size > blocks.back().capacity()) {
+        blocks.emplace_back();
+        blocks.back().reserve(blocksize);
+    }
+    blocks.back().insert(blocks.back().end(), p, p + size);
+}
+
+bool FDBinaryWriter::sync_due() const {
+    if(!nbuffered && !nunsynced) return false;
+    if(durability == DURABLE_PERIODIC)
+        return std::chrono::steady_clock::now() - tsync >= std::chrono::duration<double>(sync_interval);
+    if(durability == DURABLE_BYTES) return nbuffered + nunsynced >= sync_bytes;
+    return false;
+}
+
+void FDBinaryWriter::flush() {
+    if(durability == DURABLE_STRICT) { commit(true); return; }
+
+    bool full, due;
+    {
+        std::lock_guard<std::mutex> lb(bufMut);
+        if(flushErr) { auto e = flushErr; flushErr = nullptr; std::rethrow_exception(e); }
+        full = nbuffered >= bufsize;
+        due = sync_due();
+    }
+    // leave group commit to flusher; write out directly only when buffer full
+    if(due && flusher.joinable()) { flushCond.notify_one(); due = false; }
+    if(full || due) commit(due);
+}
+
+void FDBinaryWriter::commit(bool sync) {
+    std::lock_guard<std::mutex> lio(ioMut);
+
+    vector<vector<char>> b;
+    {
+        std::lock_guard<std::mutex> lb(bufMut);
+        std::swap(b, blocks);
+        nbuffered = 0;
+    }
+
+    size_t nw = 0;
+    if(b.size()) {
+        if(fOut < 0) throw std::logic_error("invalid object write");
+        vector<iovec> iov;
+        for(auto& d: b) iov.push_back({d.data(), d.size()});
+        size_t i = 0;
+        while(i < iov.size()) {
+            auto r = writev(fOut, iov.data() + i, std::min(iov.size() - i, size_t(IOV_MAX)));
+            if(r <= 0) throw std::runtime_error("Can't write file");
+            ++n_writes;
+            nw += r;
+            // advance past completed blocks, resuming any partial write
+            for(; i < iov.size() && size_t(r) >= iov[i].iov_len; ++i) r -= iov[i].iov_len;
+            if(i < iov.size()) {
+                iov[i].iov_base = static_cast<char*>(iov[i].iov_base) + r;
+                iov[i].iov_len -= r;
+            }
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lb(bufMut);
+        nunsynced += nw;
+        if(!sync || !nunsynced || fOut < 0) return;
+    }
+    if(fsync(fOut)) throw std::runtime_error("failed to fsync output file");
+    ++n_syncs;
+    std::lock_guard<std::mutex> lb(bufMut);
+    nunsynced = 0;
+    tsync = std::chrono::steady_clock::now();
+}
+
+void FDBinaryWriter::check_error() {
+    std::lock_guard<std::mutex> lb(bufMut);
+    if(flushErr) { auto e = flushErr; flushErr = nullptr; std::rethrow_exception(e); }
+}
+
+void FDBinaryWriter::startFlusher(double dt) {
+    stopFlusher();
+    flusherRun = true;
+    flusher = std::thread([this, dt] {
+        std::unique_lock<std::mutex> lk(bufMut);
+        while(flusherRun) {
+            flushCond.wait_for(lk, std::chrono::duration<double>(dt));
+            bool due = sync_due();
+            lk.unlock();
+            try { commit(due); }
+            catch(...) {
+                lk.lock();
+                flushErr = std::current_exception();
+                continue;
+            }
+            lk.lock();
+        }
+    });
+}
+
+void FDBinaryWriter::stopFlusher() {
+    if(!flusher.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lb(bufMut);
+        flusherRun = false;
+    }
+    flushCond.notify_one();
+    flusher.join();
 }
 
 void FDBinaryReader::openIn(const string& s) {
@@ -15,8 +152,7 @@ void FDBinaryReader::openIn(const string& s) {
 }
 
 void FDBinaryWriter::openOut(const string& s, bool append) {
-    if(fOut >= 0) close(fOut);
-    fOut = -1;
+    closeOut();
     if(s.size()) {
         auto flags = O_WRONLY | O_CREAT;
         if(append) flags = flags | O_APPEND;
@@ -26,6 +162,65 @@ void FDBinaryWriter::openOut(const string& s, bool append) {
 }
 
 void FDBinaryWriter::closeOut() {
+    stopFlusher();
+    if(fOut >= 0) commit(durability != DURABLE_NONE);
+    check_error();
     if(fOut >= 0 && close(fOut)) throw std::runtime_error("Failure closing output file!");
     fOut = -1;
 }
+
+void MMapBReader::openIn(const string& s, mmap_advice_t a, bool hugepages) {
+    closeIn();
+    if(!s.size()) return;
+    int fd = open(s.c_str(), O_RDONLY);
+    if(fd < 0) return;
+
+    struct stat st;
+    if(fstat(fd, &st)) { close(fd); throw std::runtime_error("Failure reading size of '" + s + "'"); }
+    mapsize = st.st_size;
+    if(mapsize) {
+        mapped = mmap(nullptr, mapsize, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(mapped == MAP_FAILED) {
+            mapped = nullptr;
+            mapsize = 0;
+            close(fd);
+            throw std::runtime_error("Failure mapping input file '" + s + "'");
+        }
+    }
+    close(fd);  // mapping persists after close
+    isOpen = true;
+    setReadBuffer(mapped, mapsize);
+
+#ifdef MADV_HUGEPAGE
+    if(hugepages && mapped) madvise(mapped, mapsize, MADV_HUGEPAGE); // advisory only; ignored where unsupported
+#else
+    (void)hugepages;
+#endif
+    advise(a);
+}
+
+void MMapBReader::closeIn() {
+    if(mapped) munmap(mapped, mapsize);
+    mapped = nullptr;
+    mapsize = 0;
+    isOpen = false;
+    setReadBuffer(nullptr, 0);
+}
+
+void MMapBReader::advise(mmap_advice_t a, size_t offset, size_t n) {
+    if(!mapped) return;
+    offset += position();
+    if(offset >= mapsize) return;
+    if(!n || n > mapsize - offset) n = mapsize - offset;
+
+    // madvise requires page-aligned start
+    static const size_t pg = sysconf(_SC_PAGESIZE);
+    auto p0 = offset - offset % pg;
+    n += offset - p0;
+
+    int adv = MADV_NORMAL;
+    if(a == MMAP_SEQUENTIAL) adv = MADV_SEQUENTIAL;
+    else if(a == MMAP_WILLNEED) adv = MADV_WILLNEED;
+    else if(a == MMAP_RANDOM) adv = MADV_RANDOM;
+    madvise(static_cast<char*>(mapped) + p0, n, adv);   // hints only: failure not an error
+}
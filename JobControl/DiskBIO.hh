@@ -4,9 +4,16 @@
 #define DISKBIO_HH
 
 #include "BinaryIO.hh"
+#include "MemBIO.hh"
 #include <iostream>
 #include <fstream>
 #include <unistd.h>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <chrono>
+#include <atomic>
+#include <exception>
 
 /// Binary write to iostream objects
 class IOStreamBWrite: virtual public BinaryWriter {
@@ -40,30 +47,84 @@ protected:
 };
 
 
+/// Durability policy for buffered file output
+enum durability_t {
+    DURABLE_STRICT,     ///< write and fsync every outermost transaction
+    DURABLE_NONE,       ///< buffered writes, never synced (left to the OS)
+    DURABLE_PERIODIC,   ///< buffered writes, synced at most every sync_interval seconds
+    DURABLE_BYTES,      ///< buffered writes, synced after every sync_bytes written
+    DURABLE_BARRIER     ///< buffered writes, synced only at explicit barrier() (and on close)
+};
+
 /// Binary write via Unix file descriptors
+///
+/// In the default DURABLE_STRICT mode each completed transaction is written and fsync'd immediately.
+/// Other modes collect transactions in an internal buffer of fixed-size blocks, submitted together by
+/// writev when full or due for sync; an optional background flusher thread group-commits the buffer.
 class FDBinaryWriter: virtual public BinaryWriter {
 public:
     /// Constructor
     explicit FDBinaryWriter(int fdOut = -1): fOut(fdOut) { }
     /// Constructor with filenames
     explicit FDBinaryWriter(const string& nOut, bool append = false) { openOut(nOut, append); }
-    /// Destructor
-    ~FDBinaryWriter() { FDBinaryWriter::flush(); closeOut(); }
+    /// Destructor, closing output; errors are reported, not thrown (call closeOut() to catch them)
+    ~FDBinaryWriter();
 
     /// open output file
     void openOut(const string& s, bool append = false);
-    /// close input file
+    /// close output file (stopping any flusher), after writing out and (unless DURABLE_NONE) syncing buffered data
     void closeOut();
     /// check if output open
     bool outIsOpen() const { return fOut != -1; }
 
+    /// set durability policy; buffered modes sync per interval [s] or nbytes written
+    void setDurability(durability_t d, double interval = 1., size_t nbytes = 1 << 24);
+    /// get durability policy
+    durability_t getDurability() const { return durability; }
+    /// set buffer capacity [bytes] before buffered data is written out
+    void setBufferSize(size_t n) { bufsize = n; }
+    /// start background flusher thread, group-committing buffered data every dt seconds
+    void startFlusher(double dt);
+    /// stop background flusher thread
+    void stopFlusher();
+    /// write out all buffered data and wait until it is synced to disk
+    void barrier() { commit(true); }
+
+    std::atomic<size_t> n_writes{0};    ///< number of write/writev calls (from caller and flusher threads)
+    std::atomic<size_t> n_syncs{0};     ///< number of fsync calls (from caller and flusher threads)
+
 protected:
-    /// blocking data send
+    /// blocking data send (or buffer, in non-strict modes)
     void _send(const void* vptr, size_t size) override;
-    /// flush output
-    void flush() override { if(fOut >= 0 && fsync(fOut)) throw std::runtime_error("failed to fsync output file"); }
-
-    int fOut = -1;   ///< output file descriptor
+    /// end-of-transaction flush according to durability policy
+    void flush() override;
+
+    /// write out buffered blocks, optionally followed by fsync
+    void commit(bool sync);
+    /// whether buffered data is due for sync (call with bufMut held)
+    bool sync_due() const;
+    /// rethrow any error from background flusher
+    void check_error();
+
+    int fOut = -1;      ///< output file descriptor
+
+    durability_t durability = DURABLE_STRICT;   ///< durability policy
+    double sync_interval = 1.;                  ///< DURABLE_PERIODIC sync interval [s]
+    size_t sync_bytes = 1 << 24;                ///< DURABLE_BYTES sync interval [bytes]
+    size_t bufsize = 1 << 22;                   ///< buffered bytes before write-out
+    static constexpr size_t blocksize = 1 << 16;    ///< buffer block size
+
+    std::mutex bufMut;              ///< protects buffer, sync status, and flusher state
+    std::mutex ioMut;               ///< serializes writes to file
+    vector<vector<char>> blocks;    ///< buffered transaction data blocks
+    size_t nbuffered = 0;           ///< bytes in buffer
+    size_t nunsynced = 0;           ///< bytes written since last sync
+    std::chrono::steady_clock::time_point tsync = std::chrono::steady_clock::now(); ///< time of last sync
+
+    std::thread flusher;            ///< background flusher thread
+    std::condition_variable flushCond;  ///< flusher wakeup
+    bool flusherRun = false;        ///< flusher continuation flag
+    std::exception_ptr flushErr;    ///< error caught in flusher thread
 };
 
 
@@ -96,4 +157,45 @@ protected:
     int fIn = -1;    ///< input file descriptor
 };
 
+
+/// Access pattern hints for memory-mapped input
+enum mmap_advice_t {
+    MMAP_NORMAL,        ///< no special treatment
+    MMAP_SEQUENTIAL,    ///< aggressive read-ahead, pages may be freed soon after access
+    MMAP_WILLNEED,      ///< pre-fetch whole file
+    MMAP_RANDOM         ///< no read-ahead
+};
+
+/// Binary read from memory-mapped file: reads are copies out of the mapping, and read_view/receive_view are zero-copy
+class MMapBReader: public MemBReader {
+public:
+    /// Constructor with filename
+    explicit MMapBReader(const string& nIn = "", mmap_advice_t a = MMAP_SEQUENTIAL, bool hugepages = false) { openIn(nIn, a, hugepages); }
+    /// Destructor
+    ~MMapBReader() { closeIn(); }
+    /// no copying
+    MMapBReader(const MMapBReader&) = delete;
+    /// no assignment
+    MMapBReader& operator=(const MMapBReader&) = delete;
+
+    /// map input file (not open if file does not exist), with access hint and optional transparent huge pages
+    void openIn(const string& s, mmap_advice_t a = MMAP_SEQUENTIAL, bool hugepages = false);
+    /// unmap input file
+    void closeIn();
+    /// check if input open
+    bool inIsOpen() const { return isOpen; }
+    /// apply access hint to n bytes (0 for all) at offset from current read position
+    void advise(mmap_advice_t a, size_t offset = 0, size_t n = 0);
+
+    /// mapped file size
+    size_t fileSize() const { return mapsize; }
+    /// current read position in file
+    size_t position() const { return pR - dR; }
+
+protected:
+    bool isOpen = false;        ///< whether file opened
+    void* mapped = nullptr;     ///< file mapping (nullptr for empty file)
+    size_t mapsize = 0;         ///< mapping size
+};
+
 #endif
@@ -0,0 +1,257 @@
+/// @file FlatKeyTable.cc
+
+#include "FlatKeyTable.hh"
+
+/// wire format identifier
+static const uint32_t fkt_magic = 0x31544b46; // "FKT1"
+
+FlatKeyTable::FlatKeyTable(size_t nreserve) {
+    size_t n = 16;
+    while(n < 2*nreserve) n *= 2;
+    slots.resize(n);
+    entries.reserve(nreserve);
+}
+
+void FlatKeyTable::Clear() {
+    entries.clear();
+    arena.clear();
+    std::fill(slots.begin(), slots.end(), 0);
+    dead = 0;
+}
+
+uint64_t FlatKeyTable::hashKey(const char* k, size_t n) {
+    // FNV-1a
+    uint64_t h = 0xcbf29ce484222325ULL;
+    while(n--) {
+        h ^= (unsigned char)*(k++);
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+size_t FlatKeyTable::findSlot(uint64_t h, const char* k, size_t n) const {
+    size_t mask = slots.size() - 1;
+    for(size_t i = h & mask; ; i = (i + 1) & mask) {
+        if(!slots[i]) return i;
+        auto& e = entries[slots[i] - 1];
+        if(e.hash == h && e.keylen == n && !std::memcmp(arena.data() + e.keyoff, k, n)) return i;
+    }
+}
+
+long FlatKeyTable::findEntry(const string& k) const {
+    auto s = slots[findSlot(hashKey(k.data(), k.size()), k.data(), k.size())];
+    return long(s) - 1;
+}
+
+void FlatKeyTable::rehash(size_t nslots) {
+    slots.assign(nslots, 0);
+    size_t mask = nslots - 1;
+    for(size_t j = 0; j < entries.size(); ++j) {
+        size_t i = entries[j].hash & mask;
+        while(slots[i]) i = (i + 1) & mask;
+        slots[i] = j + 1;
+    }
+}
+
+uint64_t FlatKeyTable::alloc(size_t n, size_t a) {
+    const size_t A = alignof(std::max_align_t);
+    size_t o = arena.size();
+    o += (A - (o + a) % A) % A;
+    arena.resize(o + n);
+    return o;
+}
+
+uint64_t FlatKeyTable::place(const string& k, uint32_t what, size_t n, size_t a, bool& replaced) {
+    if(n > UINT32_MAX) throw std::range_error("FlatKeyTable entry too large");
+    auto h = hashKey(k.data(), k.size());
+    auto s = findSlot(h, k.data(), k.size());
+    replaced = slots[s];
+
+    if(replaced) {
+        auto& e = entries[slots[s] - 1];
+        // overwrite in place when layout unchanged
+        if(e.size == n && (e.what >= FKT_ARRAY) == (what >= FKT_ARRAY)) {
+            e.what = what;
+            return e.dataoff;
+        }
+        dead += e.size;
+        auto o = alloc(n, a);
+        auto& e2 = entries[slots[s] - 1];
+        e2.dataoff = o;
+        e2.what = what;
+        e2.size = n;
+        return o;
+    }
+
+    fkt_entry_t e;
+    e.hash = h;
+    e.keylen = k.size();
+    e.keyoff = arena.size();
+    arena.insert(arena.end(), k.begin(), k.end());
+    e.dataoff = alloc(n, a);
+    e.what = what;
+    e.size = n;
+    entries.push_back(e);
+    slots[s] = entries.size();
+    if(2*entries.size() > slots.size()) rehash(2*slots.size());
+    return e.dataoff;
+}
+
+bool FlatKeyTable::SetRaw(const string& k, uint32_t what, const void* p, size_t n) {
+    bool replaced;
+    auto o = place(k, what, n, what >= FKT_ARRAY? sizeof(uint32_t) : 0, replaced);
+    if(n) std::memcpy(arena.data() + o, p, n);
+    compact();
+    return replaced;
+}
+
+bool FlatKeyTable::setArray(const string& k, uint32_t what, const void* p, size_t n) {
+    bool replaced;
+    // array data aligned after byte-count header
+    auto o = place(k, what, n + sizeof(uint32_t), sizeof(uint32_t), replaced);
+    uint32_t nn = n;
+    std::memcpy(arena.data() + o, &nn, sizeof(nn));
+    if(n) std::memcpy(arena.data() + o + sizeof(nn), p, n);
+    compact();
+    return replaced;
+}
+
+bool FlatKeyTable::Unset(const string& k) {
+    auto h = hashKey(k.data(), k.size());
+    size_t i = findSlot(h, k.data(), k.size());
+    if(!slots[i]) return false;
+    size_t j = slots[i] - 1;
+    dead += entries[j].keylen + entries[j].size;
+
+    // backward-shift deletion from linear-probed index
+    size_t mask = slots.size() - 1;
+    slots[i] = 0;
+    for(size_t n = (i + 1) & mask; slots[n]; n = (n + 1) & mask) {
+        size_t home = entries[slots[n] - 1].hash & mask;
+        if(((n - home) & mask) >= ((n - i) & mask)) {
+            slots[i] = slots[n];
+            slots[n] = 0;
+            i = n;
+        }
+    }
+
+    // move last entry into vacated record
+    size_t last = entries.size() - 1;
+    if(j != last) {
+        auto& e = entries[last];
+        size_t s = e.hash & mask;
+        while(slots[s] != last + 1) s = (s + 1) & mask;
+        slots[s] = j + 1;
+        entries[j] = e;
+    }
+    entries.pop_back();
+    compact();
+    return true;
+}
+
+const char* FlatKeyTable::FindRaw(const string& k, uint32_t& what, uint32_t& n) const {
+    auto i = findEntry(k);
+    if(i < 0) return nullptr;
+    what = entries[i].what;
+    n = entries[i].size;
+    return arena.data() + entries[i].dataoff;
+}
+
+void FlatKeyTable::compact() {
+    if(dead < 4096 || 2*dead < arena.size()) return;
+    vector<char> a;
+    a.reserve(arena.size() - dead);
+    std::swap(a, arena);
+    for(auto& e: entries) {
+        auto ko = arena.size();
+        arena.insert(arena.end(), a.data() + e.keyoff, a.data() + e.keyoff + e.keylen);
+        e.keyoff = ko;
+        auto o = alloc(e.size, e.what >= FKT_ARRAY? sizeof(uint32_t) : 0);
+        std::memcpy(arena.data() + o, a.data() + e.dataoff, e.size);
+        e.dataoff = o;
+    }
+    dead = 0;
+}
+
+/// element-wise sum of n values
+template<typename T>
+static void addValues(char* dst, const char* src, size_t n) {
+    T x, y;
+    for(size_t i = 0; i < n; ++i, dst += sizeof(T), src += sizeof(T)) {
+        std::memcpy(&x, dst, sizeof(T));
+        std::memcpy(&y, src, sizeof(T));
+        x += y;
+        std::memcpy(dst, &x, sizeof(T));
+    }
+}
+
+void FlatKeyTable::Add(const string& k, const FlatKeyTable& other) {
+    auto i = findEntry(k);
+    auto j = other.findEntry(k);
+    if(i < 0 || j < 0) throw std::runtime_error("No such object: '"+k+"'");
+    auto& e = entries[i];
+    auto& f = other.entries[j];
+    if(e.what != f.what) throw std::domain_error("Incompatible accumulation types!");
+    if(e.size != f.size) throw std::domain_error("Incompatible data sizes!");
+    if(this == &other) throw std::logic_error("Accumulating into self");
+
+    int w = e.what;
+    if(w < FKT_BINARY) throw std::domain_error("Non-accumulable type!");
+    size_t h = 0;
+    if(w < FKT_ARRAY) w -= FKT_BINARY;
+    else {
+        w -= FKT_ARRAY;
+        h = sizeof(uint32_t);
+    }
+    char* dst = arena.data() + e.dataoff + h;
+    const char* src = other.arena.data() + f.dataoff + h;
+    size_t n = e.size - h;
+
+    /* */if(w == flatKeyTypeID<  int8_t>()) addValues<int8_t>(dst, src, n/sizeof(int8_t));
+    else if(w == flatKeyTypeID< int16_t>()) addValues<int16_t>(dst, src, n/sizeof(int16_t));
+    else if(w == flatKeyTypeID< int32_t>()) addValues<int32_t>(dst, src, n/sizeof(int32_t));
+    else if(w == flatKeyTypeID< int64_t>()) addValues<int64_t>(dst, src, n/sizeof(int64_t));
+    else if(w == flatKeyTypeID< uint8_t>()) addValues<uint8_t>(dst, src, n/sizeof(uint8_t));
+    else if(w == flatKeyTypeID<uint16_t>()) addValues<uint16_t>(dst, src, n/sizeof(uint16_t));
+    else if(w == flatKeyTypeID<uint32_t>()) addValues<uint32_t>(dst, src, n/sizeof(uint32_t));
+    else if(w == flatKeyTypeID<uint64_t>()) addValues<uint64_t>(dst, src, n/sizeof(uint64_t));
+    else if(w == flatKeyTypeID<   float>()) addValues<float>(dst, src, n/sizeof(float));
+    else if(w == flatKeyTypeID<  double>()) addValues<double>(dst, src, n/sizeof(double));
+    else if(w == flatKeyTypeID<long double>()) addValues<long double>(dst, src, n/sizeof(long double));
+    else throw std::domain_error("Non-accumulable type!");
+}
+
+void FlatKeyTable::write(BinaryWriter& W) const {
+    W.start_wtx();
+    W.send(fkt_magic);
+    W.send<uint32_t>(entries.size());
+    W.send<uint64_t>(arena.size());
+    W.send(entries.data(), entries.size()*sizeof(fkt_entry_t));
+    W.send(arena.data(), arena.size());
+    W.end_wtx();
+}
+
+void FlatKeyTable::read(BinaryReader& R) {
+    if(R.receive<uint32_t>() != fkt_magic) throw std::runtime_error("Invalid FlatKeyTable data");
+    entries.resize(R.receive<uint32_t>());
+    arena.resize(R.receive<uint64_t>());
+    if(entries.size()) R.read(entries.data(), entries.size()*sizeof(fkt_entry_t));
+    if(arena.size()) R.read(arena.data(), arena.size());
+    dead = 0;
+
+    for(auto& e: entries)
+        if(e.keyoff + e.keylen > arena.size() || e.dataoff + e.size > arena.size()) throw std::runtime_error("Corrupt FlatKeyTable data");
+
+    size_t n = 16;
+    while(n < 2*entries.size() + 1) n *= 2;
+    rehash(n);
+}
+
+void FlatKeyTable::display() const {
+    printf("FlatKeyTable with %zu entries (%zu bytes, %zu unused)\n", size(), arena.size(), dead);
+    for(auto& e: entries) {
+        printf("\t* %.*s: [%u: %u]", int(e.keylen), arena.data() + e.keyoff, e.what, e.size);
+        if(e.what/10000 == 2 && ((e.what/1000) & 1)) { double x; get(e, x); printf(" -> %g", x); }
+        printf("\n");
+    }
+}
@@ -0,0 +1,203 @@
+/// @file FlatKeyTable.hh ROOT-independent (string) key : value table with flat hash index and contiguous storage
+
+#ifndef FLATKEYTABLE_HH
+#define FLATKEYTABLE_HH
+
+#include "MemBIO.hh"
+#include <algorithm>
+#include <sstream>
+
+/// KeyData-compatible contents type codes
+enum flatkey_contents_t {
+    FKT_OBJECT = 130,       ///< serialized ROOT TObject (= ROOT kMESS_OBJECT)
+    FKT_BINARY = 20000,     ///< generic binary blob (= KeyData::kMESS_BINARY)
+    FKT_ARRAY  = 30000      ///< array [uint32_t data size in bytes][data...] (= KeyData::kMESS_ARRAY)
+};
+
+/// identifiers for data types, shared with KeyData --- compose with FKT_BINARY / FKT_ARRAY
+template<typename T>
+int flatKeyTypeID(int i = 0) {
+    i += std::min(sizeof(T), size_t(999));
+    if(std::is_arithmetic<T>::value) {
+        i += 1000;
+        if(std::is_signed<T>::value) i += 2000;
+        if(std::is_integral<T>::value) i += 4000;
+    }
+    return i;
+}
+
+/// FlatKeyTable entry record (fixed-size, part of wire format)
+struct fkt_entry_t {
+    uint64_t hash;      ///< key hash
+    uint64_t keyoff;    ///< key position in arena
+    uint64_t dataoff;   ///< data position in arena
+    uint32_t keylen;    ///< key length
+    uint32_t what;      ///< contents type code
+    uint32_t size;      ///< data size [bytes]
+    uint32_t pad = 0;   ///< padding to 8-byte multiple
+};
+
+/// string key : value table, storing keys and data contiguously in one arena with an open-addressing hash index
+///
+/// Entry contents match KeyData binary layout (and type codes), so tables convert to/from KeyTable
+/// without reinterpretation; ROOT objects are carried only as serialized FKT_OBJECT blobs.
+/// Pointers into contents are invalidated by any modification of the table.
+class FlatKeyTable {
+public:
+    /// Constructor, with expected number of entries
+    explicit FlatKeyTable(size_t nreserve = 0);
+
+    /// number of entries
+    size_t size() const { return entries.size(); }
+    /// Clear data
+    void Clear();
+
+    /// Set raw contents with type code; return 'true' if previous key replaced
+    bool SetRaw(const string& k, uint32_t what, const void* p, size_t n);
+    /// Set numeric or other trivially-copyable value
+    template<typename T, typename std::enable_if<IS_TRIVIALLY_COPYABLE(T) && !std::is_pointer<T>::value>::type* = nullptr>
+    bool Set(const string& k, const T& x) { return SetRaw(k, flatKeyTypeID<T>(FKT_BINARY), &x, sizeof(T)); }
+    /// Set array contents
+    template<typename T>
+    bool Set(const string& k, const vector<T>& v) {
+        static_assert(is_bulk_copyable<T>::value, "FlatKeyTable arrays need raw-bytes element type");
+        return setArray(k, flatKeyTypeID<T>(FKT_ARRAY), v.data(), v.size()*sizeof(T));
+    }
+    /// Set string contents
+    bool Set(const string& k, const string& s) { return setArray(k, flatKeyTypeID<unsigned char>(FKT_ARRAY), s.data(), s.size()); }
+    /// Set string from C string
+    bool Set(const string& k, const char* s) { return Set(k, string(s)); }
+    /// Remove value for key (return whether present)
+    bool Unset(const string& k);
+
+    /// check whether key is present
+    bool Has(const string& k) const { return findEntry(k) >= 0; }
+    /// raw contents for key, or nullptr if undefined; fills type code and size
+    const char* FindRaw(const string& k, uint32_t& what, uint32_t& n) const;
+
+    /// Get generic type; return whether found
+    template<typename T>
+    bool Get(const string& k, T& x, bool warn = false) const {
+        auto i = findEntry(k);
+        if(i < 0) {
+            if(warn) printf("FlatKeyTable does not contain '%s'!\n", k.c_str());
+            return false;
+        }
+        get(entries[i], x);
+        return true;
+    }
+    /// Get generic type out-of-place (required to exist)
+    template<typename T>
+    T Get(const string& k) const {
+        T t{};
+        if(!Get(k, t, true)) throw std::runtime_error("No such object: '"+k+"'");
+        return t;
+    }
+    /// Get value with default
+    template<typename T>
+    T GetDefault(const string& k, T dflt) const { Get(k, dflt, false); return dflt; }
+
+    /// Get modifiable pointer to array contents, or nullptr if undefined
+    template<typename T>
+    T* GetArrayPtr(const string& k) {
+        auto i = findEntry(k);
+        if(i < 0) return nullptr;
+        if(entries[i].what < FKT_ARRAY) throw std::runtime_error("Incorrect data type for array");
+        return reinterpret_cast<T*>(arena.data() + entries[i].dataoff + sizeof(uint32_t));
+    }
+    /// Array size for specified type
+    template<typename T>
+    size_t vSize(const string& k) const {
+        auto i = findEntry(k);
+        if(i < 0) return 0;
+        if(entries[i].what < FKT_ARRAY) throw std::runtime_error("Incorrect data type for array");
+        return arrayBytes(entries[i])/sizeof(T);
+    }
+
+    /// accumulate numeric (scalar or array) contents of key from other table, which must have matching type and size
+    void Add(const string& k, const FlatKeyTable& other);
+
+    /// call f(key, what, data, size) for each entry
+    template<typename F>
+    void ForEach(F f) const {
+        for(auto& e: entries) f(string(arena.data() + e.keyoff, e.keylen), e.what, arena.data() + e.dataoff, e.size);
+    }
+
+    /// serialize whole table as one contiguous write transaction
+    void write(BinaryWriter& W) const;
+    /// deserialize table, replacing current contents
+    void read(BinaryReader& R);
+
+    /// debugging dump to stdout
+    void display() const;
+
+protected:
+    /// key hash
+    static uint64_t hashKey(const char* k, size_t n);
+    /// index entry for key, or -1 if missing
+    long findEntry(const string& k) const;
+    /// slot for key hash, containing key's entry or empty
+    size_t findSlot(uint64_t h, const char* k, size_t n) const;
+    /// rebuild hash index with given (power-of-2) number of slots
+    void rehash(size_t nslots);
+    /// allocate n bytes in arena, positioned so (offset + a) is max-aligned; return offset
+    uint64_t alloc(size_t n, size_t a = 0);
+    /// allocate and set entry contents; return data position
+    uint64_t place(const string& k, uint32_t what, size_t n, size_t a, bool& replaced);
+    /// set array contents with byte-count header
+    bool setArray(const string& k, uint32_t what, const void* p, size_t n);
+    /// repack arena if mostly dead space
+    void compact();
+
+    /// bytes in array contents
+    size_t arrayBytes(const fkt_entry_t& e) const { uint32_t n; std::memcpy(&n, arena.data() + e.dataoff, sizeof(n)); return n; }
+    /// in-place reader over entry contents
+    MemBReader reader(const fkt_entry_t& e) const { return MemBReader(arena.data() + e.dataoff, e.size); }
+
+    /// Get numeric type, converting from any stored numeric type
+    template<typename T, typename std::enable_if<std::is_arithmetic<T>::value>::type* = nullptr>
+    void get(const fkt_entry_t& e, T& x) const {
+        const char* p = arena.data() + e.dataoff;
+        auto w = int(e.what) - FKT_BINARY;
+        /* */if(w == flatKeyTypeID<T>()) std::memcpy(&x, p, sizeof(T));
+        else if(w == flatKeyTypeID<  int8_t>()) x = T(getAs<int8_t>(p));
+        else if(w == flatKeyTypeID< int16_t>()) x = T(getAs<int16_t>(p));
+        else if(w == flatKeyTypeID< int32_t>()) x = T(getAs<int32_t>(p));
+        else if(w == flatKeyTypeID< int64_t>()) x = T(getAs<int64_t>(p));
+        else if(w == flatKeyTypeID< uint8_t>()) x = T(getAs<uint8_t>(p));
+        else if(w == flatKeyTypeID<uint16_t>()) x = T(getAs<uint16_t>(p));
+        else if(w == flatKeyTypeID<uint32_t>()) x = T(getAs<uint32_t>(p));
+        else if(w == flatKeyTypeID<uint64_t>()) x = T(getAs<uint64_t>(p));
+        else if(w == flatKeyTypeID<   float>()) x = T(getAs<float>(p));
+        else if(w == flatKeyTypeID<  double>()) x = T(getAs<double>(p));
+        else if(w == flatKeyTypeID<long double>()) x = T(getAs<long double>(p));
+        else {
+            std::stringstream ss;
+            ss << "Unidentified numeric type " << e.what;
+            throw std::domain_error(ss.str());
+        }
+    }
+    /// Get generic non-numeric type, as deserialized from contents
+    template<typename T, typename std::enable_if<!std::is_arithmetic<T>::value>::type* = nullptr>
+    void get(const fkt_entry_t& e, T& x) const {
+        if(e.what == FKT_OBJECT) throw std::runtime_error("ROOT object entry requires KeyData conversion");
+        reader(e).receive(x);
+    }
+    /// unaligned read of numeric value
+    template<typename T>
+    static T getAs(const char* p) { T x; std::memcpy(&x, p, sizeof(T)); return x; }
+
+    vector<fkt_entry_t> entries;    ///< entry records
+    vector<char> arena;             ///< keys and contents storage
+    vector<uint32_t> slots;         ///< open-addressing hash index: entry number + 1, or 0 for empty
+    size_t dead = 0;                ///< unreferenced bytes in arena
+};
+
+/// Send FlatKeyTable as contiguous block
+template<>
+inline void BinaryWriter::send(const FlatKeyTable& t) { t.write(*this); }
+/// Receive FlatKeyTable
+template<>
+inline void BinaryReader::receive(FlatKeyTable& t) { t.read(*this); }
+
+#endif
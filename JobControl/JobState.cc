@@ -20,7 +20,7 @@ bool JobState::checkState(const string& h) {
     if(!stateDir.size()) return false;
 
     auto f = sdataFile(h);
-    FDBinaryReader b(f);
+    MMapBReader b(f);
     if(!b.inIsOpen()) return false;
     //if(verbose > 3) printf("Loading persisted data from '%s'\n", f.c_str());
     b.receive(stateData[h]);
@@ -40,7 +40,7 @@ void JobState::persistState(const string& h) {
         syscmd("mkdir -p " + stateDir);
         //if(verbose > 3) printf("Persisting state data to '%s'\n", f.c_str());
         {
-            FDBinaryWriter b(f+"_tmp");
+            FDBinaryWriter b(f+"_tmp"); // default DURABLE_STRICT: synced before rename
             b.send(it->second);
         }
         syscmd("mv " + f+"_tmp" + " " + f);
@@ -86,6 +86,20 @@ bool KeyTable::_Set(const string& s, KeyData* v) {
     return false;
 }
 
+void KeyTable::toFlat(FlatKeyTable& f) const {
+    f.Clear();
+    for(auto& kv: *this) if(kv.second) f.SetRaw(kv.first, kv.second->What(), kv.second->data(), kv.second->wSize()-2*sizeof(UInt_t));
+}
+
+void KeyTable::fromFlat(const FlatKeyTable& f) {
+    Clear();
+    f.ForEach([this](const string& k, uint32_t w, const char* p, uint32_t n) {
+        auto d = new KeyData(w, n);
+        std::memcpy(d->data(), p, n);
+        _Set(k, d);
+    });
+}
+
 /////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////
 
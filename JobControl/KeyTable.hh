@@ -5,6 +5,7 @@
 #define KEY_TABLE_H
 
 #include "MemBIO.hh"
+#include "FlatKeyTable.hh"
 #include <TMessage.h>
 #include <TObject.h>
 
@@ -30,15 +31,7 @@ public:
 
     /// identifiers for data types --- compose with kMESS_BINARY / kMESS_ARRAY
     template<typename T>
-    static contents_t typeID(int i = 0) {
-        i += std::min(sizeof(T), size_t(999));
-        if(std::is_arithmetic<T>::value) {
-            i += 1000;
-            if(std::is_signed<T>::value) i += 2000;
-            if(std::is_integral<T>::value) i += 4000;
-        }
-        return contents_t(i);
-    }
+    static contents_t typeID(int i = 0) { return contents_t(flatKeyTypeID<T>(i)); }
 
     /// Default constructor
     KeyData(): TMessage(kMESS_ANY, 0) { std::memset(Buffer()+wsize, 0, BufferSize()-wsize); }
@@ -205,6 +198,9 @@ protected:
     size_t wsize = 2*sizeof(UInt_t);
 };
 
+static_assert(int(KeyData::kMESS_BINARY) == int(FKT_BINARY) && int(KeyData::kMESS_ARRAY) == int(FKT_ARRAY)
+              && int(kMESS_OBJECT) == int(FKT_OBJECT), "KeyData and FlatKeyTable type codes must agree");
+
 namespace std {
     /// Hash function for KeyData binary contents
     template<>
@@ -269,6 +265,11 @@ public:
     template<typename T>
     T* GetArrayPtr(const string& k) const { auto v = FindKey(k); return v? v->GetArrayPtr<T>() : nullptr; }
 
+    /// copy contents into FlatKeyTable
+    void toFlat(FlatKeyTable& f) const;
+    /// replace contents from FlatKeyTable
+    void fromFlat(const FlatKeyTable& f);
+
     /// debugging dump to stdout
     void display() const {
         printf("KeyTable with %zu entries\n", size());
@@ -280,6 +281,24 @@ public:
     }
 };
 
+/// Set ROOT object entry in FlatKeyTable; return 'true' if previous key replaced
+template<class C>
+bool SetROOT(FlatKeyTable& t, const string& k, const C& o) {
+    KeyData d(o);
+    return t.SetRaw(k, d.What(), d.data(), d.wSize()-2*sizeof(UInt_t));
+}
+
+/// Get ROOT object from FlatKeyTable (caller responsible for memory management), or nullptr if key undefined
+template<class C>
+C* GetROOT(const FlatKeyTable& t, const string& k) {
+    uint32_t w, n;
+    auto p = t.FindRaw(k, w, n);
+    if(!p) return nullptr;
+    KeyData d(w, n);
+    std::memcpy(d.data(), p, n);
+    return d.GetROOT<C>();
+}
+
 /// Send KeyData buffered object
 template<>
 void BinaryWriter::send(const KeyData& M);
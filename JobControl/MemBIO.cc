@@ -1,6 +1,7 @@
 /// @file
 
 #include "MemBIO.hh"
+#include <algorithm>
 
 void MemBReader::ignore(size_t n) {
     if(pR + n > eR) throw std::runtime_error("Invalid ignore quantity");
@@ -13,6 +14,20 @@ void MemBReader::read(void* vptr, size_t size) {
     pR += size;
 }
 
+size_t MemBReader::read_upto(void* vptr, size_t size) {
+    size = std::min(size, remaining());
+    if(size) std::memcpy(vptr, pR, size);
+    pR += size;
+    return size;
+}
+
+const char* MemBReader::read_view(size_t n) {
+    if(pR + n > eR) throw std::runtime_error("Invalid receive allocation");
+    auto p = pR;
+    pR += n;
+    return p;
+}
+
 
 //--------------------------------------------
 
@@ -29,8 +44,17 @@ void MemBWriter::_send(const void* vptr, size_t size) {
 
 void DequeBIO::read(void* vptr, size_t s) {
     if(size() < s) throw std::domain_error("Insufficient buffered data!");
-    auto v = reinterpret_cast<char*>(vptr);
-    while(s--) { *(v++) = front(); pop_front(); }
+    consume(vptr, s);
+}
+
+void DequeBIO::ignore(size_t n) {
+    if(size() < n) throw std::domain_error("Insufficient buffered data!");
+    discard(n);
+}
+
+const char* DequeBIO::read_view(size_t n) {
+    if(size() < n) throw std::domain_error("Insufficient buffered data!");
+    return consume_view(n);
 }
 
 
@@ -48,6 +72,18 @@ void BufferingReader::read(void* vptr, size_t size) {
     rpos += size;
 }
 
+const char* BufferingReader::read_view(size_t n) {
+    size_t rsize = rpos + n;
+    if(rsize > dat.size()) {
+        load_buf_upto(dchunk + rsize - dat.size());
+        rsize = rpos + n;
+        if(rsize > dat.size()) load_buf(rsize - dat.size());
+    }
+    auto p = dat.data() + rpos;
+    rpos += n;
+    return p;
+}
+
 size_t BufferingReader::read_upto(void* vptr, size_t size) {
     size_t rmax = std::min(rpos + size, dat.size());
     std::memcpy(vptr, dat.data()+rpos, rmax);
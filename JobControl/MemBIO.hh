@@ -4,6 +4,7 @@
 #define MEMBIO_HH
 
 #include "BinaryIO.hh"
+#include "ChunkBuffer.hh"
 
 #include <deque>
 using std::deque;
@@ -20,6 +21,12 @@ public:
     void ignore(size_t n) override;
     /// blocking data receive
     void read(void* vptr, size_t size) override;
+    /// opportunistic read of all remaining to size
+    size_t read_upto(void* vptr, size_t size) override;
+    /// in-place view of next n bytes in buffer
+    const char* read_view(size_t n) override;
+    /// bytes remaining to read
+    size_t remaining() const { return eR - pR; }
 
 protected:
     const char* dR = nullptr;   ///< read data buffer
@@ -42,13 +49,19 @@ protected:
     char* eW;   ///< end of write data buffer
 };
 
-/// I/O to a deque buffer; virtual to allow mix-in with BinaryIO inheritance
-class DequeBIO: virtual public BinaryReader, virtual public BinaryWriter, protected deque<char> {
+/// I/O through a chunked FIFO buffer; virtual to allow mix-in with BinaryIO inheritance
+class DequeBIO: virtual public BinaryReader, virtual public BinaryWriter, protected ChunkBuffer {
 protected:
     /// blocking data send
-    void _send(const void* vptr, size_t s) override { auto v = reinterpret_cast<const char*>(vptr); while(s--) push_back(*(v++)); }
+    void _send(const void* vptr, size_t s) override { append(vptr, s); }
     /// blocking data receive
     void read(void* vptr, size_t s) override;
+    /// opportunistic data receive
+    size_t read_upto(void* vptr, size_t s) override { return consume(vptr, s); }
+    /// skip over n bytes
+    void ignore(size_t n) override;
+    /// in-place view of next n bytes, if contiguous
+    const char* read_view(size_t n) override;
 };
 
 /// Buffering wrapper around another reader
@@ -62,6 +75,8 @@ public:
     void read(void* vptr, size_t size) override;
     /// opportunistic data receive
     size_t read_upto(void* vptr, size_t size) override;
+    /// in-place view of next n bytes, valid until next read
+    const char* read_view(size_t n) override;
 
 protected:
     /// reset buffer to start
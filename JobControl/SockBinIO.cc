@@ -0,0 +1,28 @@
+/// @file SockBinIO.cc
+
+#include "SockBinIO.hh"
+
+void SockBinRead::read(void* vptr, size_t size) {
+    auto v = static_cast<char*>(vptr);
+    auto n = staged.consume(v, size);
+    v += n;
+    size -= n;
+    if(!size) return;
+    if(size >= readahead) { sockread(v, size); return; }
+
+    // read whatever is available (at least the remainder) into staging buffer
+    while(staged.size() < size) {
+        auto w = staged.write_space(readahead);
+        auto r = sockread_upto(w.first, w.second);
+        if(!r) r = sockread(w.first, 1);    // blocking wait, with error reporting
+        if(!r) throw SockFDerror(*this, "Socket closed during read");
+        staged.commit_write(r);
+    }
+    staged.consume(v, size);
+}
+
+size_t SockBinRead::read_upto(void* vptr, size_t size) {
+    auto n = staged.consume(vptr, size);
+    if(n < size) n += sockread_upto(static_cast<char*>(vptr) + n, size - n);
+    return n;
+}
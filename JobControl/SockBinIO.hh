@@ -1,7 +1,11 @@
 /// @file SockBinIO.hh BinaryIO serialization/deserialization over buffered socket connection
 // Michael P. Mendenhall, LLNL 2021
 
+#ifndef SOCKBINIO_HH
+#define SOCKBINIO_HH
+
 #include "BinaryIO.hh"
+#include "ChunkBuffer.hh"
 #include "SockOutBuffer.hh"
 
 /// BinaryIO over buffered socket connection
@@ -21,14 +25,21 @@ protected:
     }
 };
 
-/// Base binary reader class with deserializer functions
+/// Base binary reader class with deserializer functions; small reads are staged through a read-ahead buffer
 class SockBinRead: public BinaryReader, public SockFD {
 public:
     /// Constructor
     explicit SockBinRead(int sfd = 0): SockFD(sfd) { }
 
     /// blocking data receive
-    void read(void* vptr, size_t size) override { sockread(reinterpret_cast<char*>(vptr), size); }
+    void read(void* vptr, size_t size) override;
     /// opportunistic data receive
-    size_t read_upto(void* vptr, size_t size) override { return sockread_upto(reinterpret_cast<char*>(vptr), size); }
+    size_t read_upto(void* vptr, size_t size) override;
+
+    size_t readahead = 1 << 14; ///< reads smaller than this are filled through staging buffer
+
+protected:
+    ChunkBuffer staged;         ///< data read ahead from socket
 };
+
+#endif
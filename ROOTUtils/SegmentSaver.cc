@@ -6,6 +6,7 @@
 #include <stdexcept>
 #include <TString.h>
 #include <TObjString.h>
+#include <TBufferFile.h>
 
 SegmentSaver::SegmentSaver(OutputManager* pnt, const string& _path, const string& inflname):
 OutputManager(_path, pnt) {
@@ -37,10 +38,45 @@ SegmentSaver::~SegmentSaver() {
 }
 
 void SegmentSaver::signal(datastream_signal_t s) {
+    if(s == DATASTREAM_CHECKPT) takeCheckpoint();
     if(s >= DATASTREAM_END)
         for(auto& kv: cumDat) kv.second->endFill();
 }
 
+void SegmentSaver::saveState(BinaryWriter& B) const {
+    B.send<size_t>(saveHists.size());
+    for(auto& kv: saveHists) {
+        TBufferFile b(TBuffer::kWrite);
+        b.WriteObject(kv.second);
+        B.send(kv.first);
+        B.send<int>(b.Length());
+        B.send(b.Buffer(), b.Length());
+    }
+}
+
+void SegmentSaver::restoreState(BinaryReader& B) {
+    auto n = B.receive<size_t>();
+    vector<char> dat;
+    while(n--) {
+        auto hname = B.receive<string>();
+        dat.resize(B.receive<int>());
+        B.read(dat.data(), dat.size());
+
+        auto it = saveHists.find(hname);
+        if(it == saveHists.end()) {
+            if(ignoreMissingHistos) continue;
+            throw std::runtime_error("Checkpoint histogram '" + hname + "' not in '" + path + "'");
+        }
+        TBufferFile b(TBuffer::kRead, dat.size(), dat.data(), false);
+        auto h = static_cast<TH1*>(b.ReadObject(TH1::Class()));
+        if(!h) throw std::runtime_error("Unreadable checkpoint histogram '" + hname + "'");
+        h->SetDirectory(nullptr);
+        it->second->Reset();
+        it->second->Add(h);
+        delete h;
+    }
+}
+
 const string& SegmentSaver::getMeta(const string& k) {
     auto it = xmeta.find(k);
     if(it != xmeta.end()) return it->second;
@@ -6,6 +6,7 @@
 
 #include "OutputManager.hh"
 #include "SignalSink.hh"
+#include "Checkpoint.hh"
 #include "TCumulativeMap.hh"
 #include "TermColor.hh"
 
@@ -22,7 +23,7 @@ using std::set;
 void resetZaxis(TH1* o);
 
 /// class for saving, retrieving, and summing data from file
-class SegmentSaver: public OutputManager, virtual public SignalSink {
+class SegmentSaver: public OutputManager, virtual public SignalSink, public Checkpointable {
 public:
     /// constructor, optionally with input filename
     explicit SegmentSaver(OutputManager* pnt, const string& _path = "SegmentSaver", const string& inflName = "");
@@ -120,6 +121,10 @@ public:
 
     /// handle datastream signals
     void signal(datastream_signal_t s) override;
+    /// save histogram contents (for checkpoint)
+    void saveState(BinaryWriter& B) const override;
+    /// restore saved histogram contents
+    void restoreState(BinaryReader& B) override;
 
     double tSetup = 0;          ///< performance profiling: time to run constructor and initialize()
     double tProcess = 0;        ///< permormance profiling: time to process data
@@ -6,6 +6,7 @@
 #include "ConfigThreader.hh"
 #include "GlobalArgs.hh"
 #include "XMLTag.hh"
+#include "BackpressureGate.hh"
 
 /// DataSink<> transmission link over socket connection
 template<typename T>
@@ -36,6 +37,12 @@ public:
         if(int(vbuff.size()) >= nvbuff) signal(DATASTREAM_NOOP);
     }
 
+    /// append batch to packet buffer
+    void push_batch(typename DataSink<T>::span_t v) override {
+        vbuff.insert(vbuff.end(), v.begin(), v.end());
+        if(int(vbuff.size()) >= nvbuff) signal(DATASTREAM_NOOP);
+    }
+
 protected:
     int nvbuff = 128;   ///< number of items to group into packet
     vector<typename std::remove_const<T>::type> vbuff;  ///< collect multiple items to buffer
@@ -51,6 +58,8 @@ public:
         optionalGlobalArg("inhost", host, "data source host");
         S.lookupValue("port", port);
         optionalGlobalArg("inport", port, "data source port");
+        string gate;
+        if(S.lookupValue("throttle", gate)) throttle = &BackpressureGate::named(gate);
     }
 
     /// Destructor
@@ -73,6 +82,10 @@ public:
 
 protected:
     map<int, ConfigThreader*> myCTs;
+    BackpressureGate* throttle = nullptr;   ///< optional downstream backpressure gate, paused at before reading input
+
+    /// wait for downstream backpressure to clear (leaving unread input to socket flow control)
+    void await_throttle() { if(throttle) throttle->wait_open(); }
 };
 
 /// Receive items for datasink over socket connection, in format vector(items, ...),signal
@@ -94,9 +107,10 @@ public:
         vector<typename std::remove_const<T>::type> v;
         datastream_signal_t s = DATASTREAM_NOOP;
         while(s != DATASTREAM_END) {
+            await_throttle();
             SBR.receive(v);
             SBR.receive(s);
-            for(auto& i: v) this->nextSink->push(i);
+            if(v.size()) nextSink->push_batch(v);
             if(s != DATASTREAM_NOOP) nextSink->signal(s);
         }
     }
@@ -125,6 +139,7 @@ public:
 
         typename SinkUser<T>::outmut_t o;
         while(true) {
+            await_throttle();
             try { SBR.receive(o); }
             catch(SockFDerror& e) {
                 printf("Ending socket input on '%s'\n", e.what());
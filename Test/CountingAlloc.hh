@@ -0,0 +1,32 @@
+/// @file CountingAlloc.hh Global allocation operators counting heap allocations, for benchmark executables
+// (replacement operators: include in exactly one translation unit per executable)
+
+#ifndef COUNTINGALLOC_HH
+#define COUNTINGALLOC_HH
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+std::atomic<size_t> n_allocs{0};        ///< number of heap allocations
+std::atomic<size_t> alloc_bytes{0};     ///< bytes allocated on heap
+
+/// counting allocator
+void* operator new(size_t n) {
+    n_allocs.fetch_add(1, std::memory_order_relaxed);
+    alloc_bytes.fetch_add(n, std::memory_order_relaxed);
+    if(void* p = malloc(n? n : 1)) return p;
+    throw std::bad_alloc();
+}
+/// counting array allocator
+void* operator new[](size_t n) { return operator new(n); }
+/// matching deallocator
+void operator delete(void* p) noexcept { free(p); }
+/// matching array deallocator
+void operator delete[](void* p) noexcept { free(p); }
+/// matching sized deallocator
+void operator delete(void* p, size_t) noexcept { free(p); }
+/// matching sized array deallocator
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+#endif
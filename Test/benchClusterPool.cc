@@ -0,0 +1,64 @@
+/// @file benchClusterPool.cc Heap allocations per cluster, copying vs. move/recycle cluster handoff into windows
+
+/*
+bin/benchClusterPool -nClusters 200000
+(stand-alone executable: replaces global allocation operators to count heap allocations)
+*/
+
+#include "ClusteredWindow.hh"
+#include "OrderedData.hh"
+#include "GlobalArgs.hh"
+#include "CodeVersion.hh"
+#include "Stopwatch.hh"
+#include "TermColor.hh"
+#include "CountingAlloc.hh"
+
+/// clustered test item
+typedef OrderedData<int> CPItem;
+/// cluster of test items
+typedef Cluster<CPItem> CPCluster;
+
+/// Window copying each cluster in (previous ClusterBuilder handoff behavior)
+template<class W>
+class CopyingWindow: public W {
+public:
+    /// Constructor
+    template<typename... Args>
+    explicit CopyingWindow(Args&&... a): W(std::forward<Args>(a)...) { this->recycleOld = false; }
+protected:
+    /// copy cluster into window
+    void _push(typename W::cluster_t& C) override { W::window_t::push(C); }
+};
+
+/// time window over input; return ns per item and allocations per cluster
+template<class W>
+void benchWindow(const char* name, const vector<CPItem>& v, size_t nClusters) {
+    W CW(50., 1.);
+    n_allocs = 0;
+    Stopwatch w;
+    for(auto& o: v) CW.push(o);
+    CW.signal(DATASTREAM_FLUSH);
+    w.stop();
+    size_t na = n_allocs;
+    printf("%s\t%.1f\t\t%.3f\t\t%zu\n", name, 1e9 * w.elapsed / v.size(), double(na) / nClusters, na);
+}
+
+int main(int argc, char** argv) {
+    CodeVersion::display_code_version();
+    loadGlobalArgs(argc - 1, argv + 1);
+
+    int nClusters = 200000;
+    optionalGlobalArg("nClusters", nClusters, "number of clusters per test");
+
+    // clusters of 1--16 items spaced by 0.1, clusters spaced by 10
+    vector<CPItem> v;
+    for(int c = 0; c < nClusters; ++c)
+        for(int i = 0; i <= (c * 7) % 16; ++i) v.emplace_back(10. * c + 0.1 * i, i);
+
+    printf("window\t\t\t[ns/item]\t[allocs/cluster]\t[allocs]\n");
+    benchWindow<CopyingWindow<ClusteredWindow<CPCluster>>>("deque, copying", v, nClusters);
+    benchWindow<ClusteredWindow<CPCluster>>("deque, recycled", v, nClusters);
+    benchWindow<CopyingWindow<RingClusteredWindow<CPCluster>>>("ring, copying", v, nClusters);
+    benchWindow<RingClusteredWindow<CPCluster>>("ring, recycled", v, nClusters);
+    return EXIT_SUCCESS;
+}
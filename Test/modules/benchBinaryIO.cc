@@ -0,0 +1,103 @@
+/// @file benchBinaryIO.cc Serialization throughput: bulk versus element-wise vector/map transfer, and zero-copy views
+
+#include "MemBIO.hh"
+#include "ConfigFactory.hh"
+#include "GlobalArgs.hh"
+#include "Stopwatch.hh"
+#include "TermColor.hh"
+
+/// element-wise BinaryReader, as before bulk transfers: one virtual read() per element
+class ElementwiseReader: public MemBReader {
+public:
+    using MemBReader::MemBReader;
+    /// element-by-element vector receive
+    template<typename T>
+    void receive_elementwise(vector<T>& v) {
+        v.resize(receive<int>()/sizeof(T));
+        for(auto& x: v) receive(x);
+    }
+};
+
+REGISTER_EXECLET(benchBinaryIO) {
+    int n = 4000000;
+    optionalGlobalArg("nItems", n, "number of vector entries");
+    int nRep = 10;
+    optionalGlobalArg("nRep", nRep, "number of repetitions");
+
+    vector<double> v(n);
+    for(int i = 0; i < n; ++i) v[i] = 0.5 * i;
+    map<int, double> m;
+    for(int i = 0; i < n / 10; ++i) m[3 * i] = i;
+
+    // serialize
+    BinarySerializer BS;
+    Stopwatch w;
+    for(int r = 0; r < nRep; ++r) {
+        BS.buf().clear();
+        BS << v;
+    }
+    w.stop();
+    printf("vector<double> send:\t\t%.3g GB/s\n", nRep * n * sizeof(double) / w.elapsed * 1e-9);
+
+    BinarySerializer BM;
+    Stopwatch wm;
+    for(int r = 0; r < nRep; ++r) {
+        BM.buf().clear();
+        BM << m;
+    }
+    wm.stop();
+    printf("map<int,double> send:\t\t%.3g M entries/s\n", nRep * m.size() / wm.elapsed * 1e-6);
+
+    // receive: bulk, element-wise, view
+    vector<double> vr;
+    double t_bulk = 0, t_elem = 0, t_view = 0, sum = 0;
+    for(int r = 0; r < nRep; ++r) {
+        MemBReader R(BS.buf().data(), BS.buf().size());
+        Stopwatch w1;
+        R >> vr;
+        w1.stop();
+        t_bulk += w1.elapsed;
+        if(vr != v) throw std::logic_error("bulk receive mismatch");
+
+        ElementwiseReader E(BS.buf().data(), BS.buf().size());
+        Stopwatch w2;
+        E.receive_elementwise(vr);
+        w2.stop();
+        t_elem += w2.elapsed;
+        if(vr != v) throw std::logic_error("element-wise receive mismatch");
+
+        MemBReader RV(BS.buf().data(), BS.buf().size());
+        Stopwatch w3;
+        auto s = RV.receive_view<double>();
+        w3.stop();
+        t_view += w3.elapsed;
+        if(s.size() != v.size() || s.back() != v.back()) throw std::logic_error("view mismatch");
+        sum += s.back();
+    }
+    double GB = nRep * n * sizeof(double) * 1e-9;
+    printf("vector<double> receive:\t\tbulk %.3g GB/s, element-wise %.3g GB/s, view %.3g GB/s\n", GB / t_bulk, GB / t_elem, GB / t_view);
+
+    // 4-byte elements following the 4-byte length header stay aligned, so are viewed in place
+    vector<float> vf(v.begin(), v.end());
+    BinarySerializer BF;
+    BF << vf;
+    Stopwatch wf;
+    for(int r = 0; r < nRep; ++r) {
+        MemBReader R(BF.buf().data(), BF.buf().size());
+        auto s = R.receive_view<float>();
+        if(s.data() != reinterpret_cast<const float*>(BF.buf().data() + sizeof(int))) throw std::logic_error("float view copied");
+    }
+    wf.stop();
+    printf("vector<float> view:		%.3g us per %zu-entry view (in place)\n", 1e6 * wf.elapsed / nRep, vf.size());
+
+    map<int, double> mr;
+    Stopwatch wr;
+    for(int r = 0; r < nRep; ++r) {
+        MemBReader R(BM.buf().data(), BM.buf().size());
+        R >> mr;
+    }
+    wr.stop();
+    if(mr != m) throw std::logic_error("map receive mismatch");
+    printf("map<int,double> receive:\t%.3g M entries/s\n", nRep * m.size() / wr.elapsed * 1e-6);
+    printf(TERMFG_GREEN "Round trips match." TERMSGR_RESET "\n");
+}
@@ -0,0 +1,93 @@
+/// @file benchCollator.cc Collator throughput scaling with number of input threads
+
+#include "ConfigCollator.hh"
+#include "Collator.hh"
+#include "OrderedData.hh"
+#include "ConfigFactory.hh"
+#include "GlobalArgs.hh"
+#include "Stopwatch.hh"
+#include <thread>
+
+/// time-ordered test item
+typedef OrderedData<int> CollItem;
+
+/// Count and check order of output
+class CollCheckSink: public DataSink<const CollItem> {
+public:
+    /// check order
+    void push(const CollItem& o) override {
+        if(o.t < tprev) ++nDisordered;
+        tprev = o.t;
+        ++n;
+    }
+    size_t n = 0;               ///< number of items received
+    size_t nDisordered = 0;     ///< number of out-of-order items
+    double tprev = -1e99;       ///< previous item time
+};
+
+/// push interleaved ordered sequence from each of k input threads
+void feedInputs(vector<DataSink<CollItem>*>& vIn, size_t nItems) {
+    const size_t k = vIn.size();
+    vector<std::thread> vt;
+    for(size_t j = 0; j < k; ++j) {
+        vt.emplace_back([&vIn, j, k, nItems]() {
+            for(size_t i = j; i < nItems; i += k) {
+                CollItem o(i, j);
+                vIn[j]->push(o);
+            }
+            vIn[j]->signal(DATASTREAM_END);
+        });
+    }
+    for(auto& t: vt) t.join();
+}
+
+/// time merge collator with k inputs
+void benchMerge(size_t k, size_t nItems) {
+    auto S = new CollCheckSink();
+    MergeCollator<CollItem> M;
+    M.setNext(S);
+    vector<DataSink<CollItem>*> vIn;
+    for(size_t j = 0; j < k; ++j) vIn.push_back(&M.new_input());
+
+    Stopwatch w;
+    M.launch_mythread();
+    feedInputs(vIn, nItems);
+    M.finish_mythread();
+    w.stop();
+    printf("%zu\t%.3g\t\t", k, S->n / w.elapsed);
+    if(S->n != nItems || S->nDisordered) printf(TERMFG_RED "*** %zu disordered, %zu missing! " TERMSGR_RESET, S->nDisordered, nItems - S->n);
+}
+
+/// time priority_queue collator with k inputs
+void benchPQ(size_t k, size_t nItems) {
+    auto S = new CollCheckSink();
+    Collator<CollItem> C;
+    C.setNext(S);
+    vector<DataSink<CollItem>*> vIn;
+    for(size_t j = 0; j < k; ++j) {
+        C.vInputs.push_back(new Collator<CollItem>::MOqInput(C));
+        vIn.push_back(C.vInputs.back());
+    }
+
+    Stopwatch w;
+    C.launch_mythread();
+    feedInputs(vIn, nItems);
+    C.finish_mythread();
+    w.stop();
+    printf("%.3g\n", S->n / w.elapsed);
+}
+
+REGISTER_EXECLET(benchCollator) {
+    int nItems = 1000000;
+    optionalGlobalArg("nItems", nItems, "number of items per test");
+    int kmax = std::max(4U, 2*std::thread::hardware_concurrency());
+    optionalGlobalArg("kmax", kmax, "maximum number of inputs");
+    int nItemsPQ = nItems/10;
+    optionalGlobalArg("nItemsPQ", nItemsPQ, "number of items per priority_queue Collator test");
+
+    printf("inputs\tMergeCollator [items/s]\tCollator [items/s]\n");
+    for(int k = 1; k <= kmax; k *= 2) {
+        benchMerge(k, nItems);
+        benchPQ(k, nItemsPQ);
+    }
+}
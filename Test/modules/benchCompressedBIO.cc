@@ -0,0 +1,88 @@
+/// @file benchCompressedBIO.cc Block-compressed stream write/read rates, sequential and parallel, in memory and on disk
+
+#include "CompressedBIO.hh"
+#include "DiskBIO.hh"
+#include "ConfigFactory.hh"
+#include "GlobalArgs.hh"
+#include "Stopwatch.hh"
+#include "TermColor.hh"
+#include <random>
+#include <cstdio>
+
+/// read back and check nr records
+static void checkRecords(BinaryReader& R, int nr, int nx) {
+    vector<double> v;
+    for(int i = 0; i < nr; ++i) {
+        R >> v;
+        if(int(v.size()) != nx || v[0] != i) throw std::logic_error("record mismatch");
+    }
+}
+
+REGISTER_EXECLET(benchCompressedBIO) {
+    int nr = 20000;
+    optionalGlobalArg("nRecords", nr, "number of records");
+    int nx = 256;
+    optionalGlobalArg("recordSize", nx, "histogram bins per record");
+    int nthreads = 0;
+    optionalGlobalArg("nThreads", nthreads, "parallel decompression threads (0 for hardware concurrency)");
+    string fname = "benchCompressedBIO.dat";
+    optionalGlobalArg("file", fname, "scratch file");
+
+    // sparse small-count histograms: compressible, but not trivially
+    std::mt19937 rng(1);
+    std::poisson_distribution<int> P(0.3);
+    vector<vector<double>> recs(nr, vector<double>(nx));
+    for(int i = 0; i < nr; ++i) {
+        for(auto& x: recs[i]) x = P(rng);
+        recs[i][0] = i;
+    }
+    double MB = nr * (nx * sizeof(double) + sizeof(int)) * 1e-6;
+
+    BinarySerializer S;
+    for(int bg = 0; bg < 2; ++bg) {
+        S.buf().clear();
+        Stopwatch w;
+        {
+            CompressedBWriter Z(S, 1 << 18, bg);
+            for(auto& r: recs) Z << r;
+        }
+        w.stop();
+        printf("compress (%s):\t%8.3g MB/s, ratio %.3g\n", bg? "background" : "inline    ", MB / w.elapsed, MB * 1e6 / S.buf().size());
+    }
+
+    Stopwatch ws;
+    MemBReader M(S.buf().data(), S.buf().size());
+    CompressedBReader ZS(M);
+    checkRecords(ZS, nr, nx);
+    ws.stop();
+    if(ZS.read_upto(&nx, 1)) throw std::logic_error("data past end of stream");
+    printf("sequential read:\t%8.3g MB/s\n", MB / ws.elapsed);
+
+    Stopwatch wp;
+    CompressedBReader ZP(S.buf().data(), S.buf().size());
+    ZP.prefetch(nthreads);
+    checkRecords(ZP, nr, nx);
+    wp.stop();
+    printf("parallel read (%zu blocks):\t%8.3g MB/s\n", ZP.blockIndex().size(), MB / wp.elapsed);
+
+    // seek to fixed-size record in middle
+    size_t recsize = sizeof(int) + nx * sizeof(double);
+    ZP.seek((nr / 2) * recsize);
+    if(ZP.receive<vector<double>>() != recs[nr / 2]) throw std::logic_error("seek mismatch");
+
+    // stacked on disk file, read back memory-mapped
+    {
+        FDBinaryWriter F(fname);
+        F.setDurability(DURABLE_BARRIER);
+        CompressedBWriter Z(F);
+        for(auto& r: recs) Z << r;
+    }
+    MMapBReader MM(fname);
+    auto n = MM.fileSize();
+    CompressedBReader ZF(MM.read_view(n), n);
+    ZF.prefetch(nthreads);
+    checkRecords(ZF, nr, nx);
+    std::remove(fname.c_str());
+
+    printf(TERMFG_GREEN "Compressed round trips match." TERMSGR_RESET "\n");
+}
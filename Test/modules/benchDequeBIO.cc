@@ -0,0 +1,80 @@
+/// @file benchDequeBIO.cc Round-trip rate through DequeBIO chunked buffer, versus per-byte deque<char>
+
+#include "MemBIO.hh"
+#include "ConfigFactory.hh"
+#include "GlobalArgs.hh"
+#include "Stopwatch.hh"
+#include "TermColor.hh"
+#include <random>
+
+/// loopback through chunked DequeBIO
+class ChunkLoopback: public DequeBIO { };
+
+/// loopback one byte at a time through deque<char>, as DequeBIO before chunked buffering
+class ByteDequeLoopback: virtual public BinaryReader, virtual public BinaryWriter, protected deque<char> {
+protected:
+    /// blocking data send
+    void _send(const void* vptr, size_t s) override { auto v = reinterpret_cast<const char*>(vptr); while(s--) push_back(*(v++)); }
+    /// blocking data receive
+    void read(void* vptr, size_t s) override {
+        if(size() < s) throw std::domain_error("Insufficient buffered data!");
+        auto v = reinterpret_cast<char*>(vptr);
+        while(s--) { *(v++) = front(); pop_front(); }
+    }
+};
+
+/// time nRep round trips of payload through loopback; return seconds
+template<class L>
+double roundtrip(L& B, const map<int, vector<double>>& m, int nRep) {
+    map<int, vector<double>> mr;
+    Stopwatch w;
+    for(int r = 0; r < nRep; ++r) {
+        B << m;
+        B >> mr;
+    }
+    w.stop();
+    if(mr != m) throw std::logic_error("round trip mismatch");
+    return w.elapsed;
+}
+
+REGISTER_EXECLET(benchDequeBIO) {
+    int nHist = 200;
+    optionalGlobalArg("nHist", nHist, "number of histograms in payload");
+    int nBins = 10000;
+    optionalGlobalArg("nBins", nBins, "bins per histogram");
+    int nRep = 10;
+    optionalGlobalArg("nRep", nRep, "number of round trips");
+
+    // randomized append/consume sizes against reference copy
+    std::mt19937 rng(1);
+    ChunkBuffer CB(1000);
+    std::deque<char> ref;
+    vector<char> b;
+    for(int i = 0; i < 10000; ++i) {
+        size_t n = rng() % 3000;
+        b.resize(n);
+        if(rng() % 2) {
+            for(auto& c: b) { c = rng(); ref.push_back(c); }
+            CB.append(b.data(), n);
+        } else {
+            n = CB.consume(b.data(), n);
+            for(size_t j = 0; j < n; ++j, ref.pop_front()) if(b[j] != ref.front()) throw std::logic_error("chunk buffer mismatch");
+        }
+        if(CB.size() != ref.size()) throw std::logic_error("chunk buffer size mismatch");
+    }
+    printf("ChunkBuffer randomized append/consume matches.\n");
+
+    map<int, vector<double>> m;
+    for(int i = 0; i < nHist; ++i) m[i] = vector<double>(nBins, i);
+    double MB = nRep * nHist * nBins * sizeof(double) * 1e-6;
+
+    ChunkLoopback C;
+    auto tc = roundtrip(C, m, nRep);
+    printf("chunked DequeBIO:\t%8.3g MB/s\n", MB / tc);
+
+    ByteDequeLoopback D;
+    int nRepD = std::max(nRep / 10, 1);   // slower reference
+    auto td = roundtrip(D, m, nRepD);
+    printf("per-byte deque<char>:\t%8.3g MB/s\n", MB * nRepD / nRep / td);
+    printf(TERMFG_GREEN "Round trips match." TERMSGR_RESET "\n");
+}
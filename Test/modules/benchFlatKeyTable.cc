@@ -0,0 +1,75 @@
+/// @file benchFlatKeyTable.cc FlatKeyTable build/lookup/transfer rates and randomized consistency check
+
+#include "FlatKeyTable.hh"
+#include "ConfigFactory.hh"
+#include "GlobalArgs.hh"
+#include "Stopwatch.hh"
+#include "TermColor.hh"
+#include <random>
+#include <memory>
+
+REGISTER_EXECLET(benchFlatKeyTable) {
+    int nKeys = 100000;
+    optionalGlobalArg("nKeys", nKeys, "number of table entries");
+
+    // randomized set/unset/overwrite against reference map
+    std::mt19937 rng(1);
+    FlatKeyTable T;
+    map<string, vector<double>> ref;
+    for(int i = 0; i < 200000; ++i) {
+        string k = "k" + std::to_string(rng() % 2000);
+        auto op = rng() % 4;
+        if(op == 0) {
+            if(T.Unset(k) != (ref.erase(k) > 0)) throw std::logic_error("Unset mismatch");
+        } else if(op == 1) {
+            vector<double> v(rng() % 20, i);
+            T.Set(k, v);
+            ref[k] = v;
+        } else {
+            vector<double> v;
+            if(T.Get(k, v) != ref.count(k) || (ref.count(k) && v != ref[k])) throw std::logic_error("Get mismatch");
+        }
+        if(T.size() != ref.size()) throw std::logic_error("size mismatch");
+    }
+    printf("Randomized FlatKeyTable operations match reference.\n");
+
+    vector<string> keys;
+    for(int i = 0; i < nKeys; ++i) keys.push_back("Observable_" + std::to_string(i));
+
+    // per-entry heap allocation in ordered map, as KeyTable
+    Stopwatch wm;
+    map<string, std::unique_ptr<double>> M;
+    for(int i = 0; i < nKeys; ++i) M[keys[i]].reset(new double(i));
+    wm.stop();
+
+    Stopwatch wf;
+    FlatKeyTable F(nKeys);
+    for(int i = 0; i < nKeys; ++i) F.Set(keys[i], double(i));
+    F.Set("hist", vector<double>(1000, 1.));
+    wf.stop();
+    printf("build %i keys:\tmap+heap %.3g us, FlatKeyTable %.3g us\n", nKeys, 1e6 * wm.elapsed, 1e6 * wf.elapsed);
+
+    double s = 0;
+    Stopwatch wlm;
+    for(auto& k: keys) s += *M.at(k);
+    wlm.stop();
+    Stopwatch wlf;
+    for(auto& k: keys) s -= F.Get<double>(k);
+    wlf.stop();
+    if(s) throw std::logic_error("lookup mismatch");
+    printf("lookup:\t\tmap+heap %.3g ns, FlatKeyTable %.3g ns per key\n", 1e9 * wlm.elapsed / nKeys, 1e9 * wlf.elapsed / nKeys);
+
+    // contiguous wire transfer
+    BinarySerializer B;
+    Stopwatch ws;
+    B << F;
+    MemBReader R(B.buf().data(), B.buf().size());
+    FlatKeyTable F2;
+    R >> F2;
+    ws.stop();
+    if(F2.size() != F.size() || F2.Get<int>(keys.back()) != nKeys - 1) throw std::logic_error("transfer mismatch");
+    F2.Add("hist", F);
+    if(F2.GetArrayPtr<double>("hist")[999] != 2.) throw std::logic_error("accumulate mismatch");
+    printf("round trip:\t%.3g us for %zu bytes\n", 1e6 * ws.elapsed, B.buf().size());
+    printf(TERMFG_GREEN "FlatKeyTable checks passed." TERMSGR_RESET "\n");
+}
@@ -0,0 +1,77 @@
+/// @file benchJobGraph.cc Overlapping dependent job stages with JobGraph, vs. flush() barriers between phases
+
+#include "JobGraph.hh"
+#include "ConfigFactory.hh"
+#include "GlobalArgs.hh"
+#include "Stopwatch.hh"
+#include "TermColor.hh"
+#include <thread>
+
+/// simulated work with varying duration (sleeping, so timing is independent of available cores)
+int work(int i, int us) {
+    usleep(us * (1 + i % 4));
+    return i;
+}
+
+/// Job storing result of simulated work
+class PhaseJob: public JobQueue::Job {
+public:
+    /// Constructor
+    PhaseJob(int _i, int _us, int& _r): i(_i), us(_us), r(_r) { }
+    /// run job
+    void run() override { r = work(i, us); }
+    int i;      ///< job number
+    int us;     ///< base work time
+    int& r;     ///< result
+};
+
+REGISTER_EXECLET(benchJobGraph) {
+    int nSeg = 64;
+    optionalGlobalArg("nSeg", nSeg, "number of segments");
+    int nThreads = std::max(4U, std::thread::hardware_concurrency());
+    optionalGlobalArg("nThreads", nThreads, "number of worker threads");
+    const int us = 1000;
+
+    StealingJobQueue JQ;
+    JQ.setQueue(1, 1); // serial merge queue
+    JQ.launch(nThreads);
+
+    // phases separated by flush(): calibrate all, fit all, then merge all
+    Stopwatch w0;
+    {
+        vector<int> cal(nSeg), fit(nSeg), merged(nSeg);
+        vector<PhaseJob> vc, vf, vm;
+        for(int i = 0; i < nSeg; ++i) vc.emplace_back(i, us, cal[i]);
+        for(auto& j: vc) JQ.add(&j);
+        JQ.flush();
+        for(int i = 0; i < nSeg; ++i) vf.emplace_back(cal[i], 2*us, fit[i]);
+        for(auto& j: vf) JQ.add(&j);
+        JQ.flush();
+        for(int i = 0; i < nSeg; ++i) { vm.emplace_back(fit[i], us/4, merged[i]); vm.back().qn = 1; }
+        for(auto& j: vm) JQ.add(&j);
+        JQ.flush();
+    }
+    w0.stop();
+
+    // same stages as dependency graph: each segment proceeds as soon as its inputs are ready
+    Stopwatch w1;
+    int total = 0;
+    {
+        JobGraph<StealingJobQueue> G(JQ);
+        DAGJob* prevMerge = nullptr;
+        for(int i = 0; i < nSeg; ++i) {
+            auto& c = G.add(0, [i, us] { return work(i, us); });
+            auto& f = G.add(0, [&c, us] { return work(c.get(), 2*us); }, {&c});
+            auto& m = G.add(1, [&f, &total, us] { total += work(f.get(), us/4); }, {&f, prevMerge});
+            prevMerge = &m;
+        }
+        G.wait();
+    }
+    w1.stop();
+
+    int expect = 0;
+    for(int i = 0; i < nSeg; ++i) expect += i;
+    printf("%i segments on %i threads: phased %.3g s, graph %.3g s\n", nSeg, nThreads, w0.elapsed, w1.elapsed);
+    if(total != expect) printf(TERMFG_RED "*** graph result %i, expected %i!" TERMSGR_RESET "\n", total, expect);
+    JQ.shutdown();
+}
@@ -0,0 +1,106 @@
+/// @file benchJobQueue.cc Scheduling overhead of JobQueue vs. StealingJobQueue on many tiny jobs
+
+#include "JobQueue.hh"
+#include "StealingJobQueue.hh"
+#include "ConfigFactory.hh"
+#include "GlobalArgs.hh"
+#include "Stopwatch.hh"
+#include "TermColor.hh"
+#include <atomic>
+#include <thread>
+
+/// Minimal job: count completion; optionally check serial ordering
+class TinyJob: public JobQueue::Job {
+public:
+    /// Constructor
+    explicit TinyJob(int q = 0, int _i = 0): Job(q), i(_i) { }
+    /// run job
+    void run() override {
+        if(last && *last + 1 != i) ++nDisordered;
+        if(last) *last = i;
+        ++nDone;
+    }
+    int i;                      ///< sequence number
+    int* last = nullptr;        ///< previous sequence number in serial queue
+    static std::atomic<size_t> nDone;       ///< number of completed jobs
+    static std::atomic<size_t> nDisordered; ///< number of out-of-order serial jobs
+};
+std::atomic<size_t> TinyJob::nDone{0};
+std::atomic<size_t> TinyJob::nDisordered{0};
+
+/// Job adding more jobs from inside worker
+class SpawnJob: public JobQueue::Job {
+public:
+    /// Constructor
+    SpawnJob(StealingJobQueue& q, vector<TinyJob>& c): JQ(q), children(c) { }
+    /// run job
+    void run() override { for(auto& j: children) JQ.add(&j); }
+    StealingJobQueue& JQ;       ///< executor
+    vector<TinyJob>& children;  ///< jobs to spawn
+};
+
+/// time adding and completing nJobs tiny jobs (plus serial queue 1 jobs); return jobs/s
+template<class JQ_t>
+double benchJobs(JQ_t& JQ, size_t nJobs, size_t nSerial) {
+    vector<TinyJob> vj(nJobs);
+    vector<TinyJob> vs;
+    int last = -1;
+    for(size_t i = 0; i < nSerial; ++i) {
+        vs.emplace_back(1, i);
+        vs.back().last = &last;
+    }
+    TinyJob::nDone = TinyJob::nDisordered = 0;
+
+    Stopwatch w;
+    for(size_t i = 0; i < nJobs; ++i) {
+        JQ.add(&vj[i]);
+        if(i < nSerial) JQ.add(&vs[i]);
+    }
+    JQ.flush();
+    w.stop();
+
+    if(TinyJob::nDone != nJobs + nSerial || TinyJob::nDisordered)
+        printf(TERMFG_RED "*** %zu/%zu jobs run, %zu disordered!" TERMSGR_RESET "\n", TinyJob::nDone.load(), nJobs + nSerial, TinyJob::nDisordered.load());
+    return (nJobs + nSerial) / w.elapsed;
+}
+
+REGISTER_EXECLET(benchJobQueue) {
+    int nJobs = 200000;
+    optionalGlobalArg("nJobs", nJobs, "number of tiny jobs per test");
+    int nThreads = std::thread::hardware_concurrency();
+    optionalGlobalArg("nThreads", nThreads, "number of worker threads");
+    const size_t nSerial = 1000;
+
+    printf("Running %i tiny jobs (plus %zu on serial queue) on %i workers\n", nJobs, nSerial, nThreads);
+
+    {
+        JobQueue JQ;
+        JQ.setQueue(1, 1);
+        JQ.launch(nThreads);
+        auto r = benchJobs(JQ, nJobs/10, nSerial);
+        printf("JobQueue:\t\t%.3g jobs/s\t(%.0f ns/job)\n", r, 1e9/r);
+        JQ.shutdown();
+    }
+
+    {
+        StealingJobQueue JQ;
+        JQ.setQueue(1, 1);
+        JQ.launch(nThreads);
+        auto r = benchJobs(JQ, nJobs, nSerial);
+        printf("StealingJobQueue:\t%.3g jobs/s\t(%.0f ns/job)\n", r, 1e9/r);
+
+        // jobs spawned from inside workers, distributed by stealing
+        size_t nSpawn = std::max(1, nThreads/2);
+        vector<vector<TinyJob>> vc(nSpawn, vector<TinyJob>(nJobs/nSpawn));
+        vector<SpawnJob> vs;
+        for(auto& c: vc) vs.emplace_back(JQ, c);
+        TinyJob::nDone = 0;
+        Stopwatch w;
+        for(auto& s: vs) JQ.add(&s);
+        JQ.flush();
+        w.stop();
+        printf("  spawned in workers:\t%.3g jobs/s\t(%zu stolen)\n", TinyJob::nDone / w.elapsed, JQ.n_stolen());
+        if(TinyJob::nDone != nSpawn * (nJobs/nSpawn)) printf(TERMFG_RED "*** %zu spawned jobs run!" TERMSGR_RESET "\n", TinyJob::nDone.load());
+        JQ.shutdown();
+    }
+}
@@ -0,0 +1,71 @@
+/// @file benchMMapBIO.cc Binary file read rates: file descriptor, iostream, and memory-mapped readers
+
+#include "DiskBIO.hh"
+#include "ConfigFactory.hh"
+#include "GlobalArgs.hh"
+#include "Stopwatch.hh"
+#include "TermColor.hh"
+#include <cstdio>
+
+/// read back nr records; return checksum
+static double readRecords(BinaryReader& R, int nr, vector<float>& v) {
+    double s = 0;
+    for(int i = 0; i < nr; ++i) {
+        R >> v;
+        s += v.back();
+    }
+    return s;
+}
+
+REGISTER_EXECLET(benchMMapBIO) {
+    string fname = "benchMMapBIO.dat";
+    optionalGlobalArg("file", fname, "scratch file");
+    int nr = 200000;
+    optionalGlobalArg("nRecords", nr, "number of records");
+    int nx = 16;
+    optionalGlobalArg("recordSize", nx, "floats per record");
+
+    vector<float> v(nx);
+    double s0 = 0;
+    {
+        FDBinaryWriter W(fname);
+        W.setDurability(DURABLE_BARRIER);
+        for(int i = 0; i < nr; ++i) {
+            v.back() = i;
+            s0 += i;
+            W << v;
+        }
+    }
+    double MB = nr * (nx * sizeof(float) + sizeof(int)) * 1e-6;
+
+    Stopwatch w1;
+    FDBinaryReader F(fname);
+    auto s1 = readRecords(F, nr, v);
+    w1.stop();
+    printf("FDBinaryReader:\t%8.3g MB/s\n", MB / w1.elapsed);
+
+    Stopwatch w2;
+    std::ifstream fi(fname, std::ios::binary);
+    IOStreamBRead I(fi);
+    auto s2 = readRecords(I, nr, v);
+    w2.stop();
+    printf("IOStreamBRead:\t%8.3g MB/s\n", MB / w2.elapsed);
+
+    Stopwatch w3;
+    MMapBReader M(fname);
+    auto s3 = readRecords(M, nr, v);
+    w3.stop();
+    printf("MMapBReader:\t%8.3g MB/s\n", MB / w3.elapsed);
+
+    // zero-copy views into mapping
+    Stopwatch w4;
+    M.openIn(fname, MMAP_WILLNEED);
+    double s4 = 0;
+    for(int i = 0; i < nr; ++i) s4 += M.receive_view<float>().back();
+    w4.stop();
+
+    if(s1 != s0 || s2 != s0 || s3 != s0 || s4 != s0) throw std::logic_error("read-back mismatch");
+    printf("MMapBReader view:\t%8.3g MB/s\n", MB / w4.elapsed);
+    std::remove(fname.c_str());
+    printf(TERMFG_GREEN "Read-back matches." TERMSGR_RESET "\n");
+}
@@ -0,0 +1,64 @@
+/// @file benchOrderingQueue.cc Compare OrderingQueue engines over disorder width and event rate
+
+#include "OrderingQueue.hh"
+#include "OrderedData.hh"
+#include "ConfigFactory.hh"
+#include "GlobalArgs.hh"
+#include "Stopwatch.hh"
+#include "TermColor.hh"
+#include <random>
+
+/// time-ordered test item
+typedef OrderedData<int> OQItem;
+
+/// Count and check order of output
+class OrderCheckSink: public DataSink<OQItem> {
+public:
+    /// check order
+    void push(OQItem& o) override {
+        if(o.t < tprev) ++nDisordered;
+        tprev = o.t;
+        ++n;
+    }
+    size_t n = 0;               ///< number of items received
+    size_t nDisordered = 0;     ///< number of out-of-order items
+    double tprev = -1e99;       ///< previous item time
+};
+
+/// time one queue type on input; return ns per item
+template<class OQ>
+double benchQueue(const vector<OQItem>& v, double dt, size_t& nDisordered) {
+    auto S = new OrderCheckSink();
+    OQ Q(S, dt);
+    Stopwatch w;
+    for(auto& o: v) Q.push(o);
+    Q.signal(DATASTREAM_FLUSH);
+    w.stop();
+    nDisordered = S->nDisordered + v.size() - S->n;
+    return 1e9 * w.elapsed / v.size();
+}
+
+REGISTER_EXECLET(benchOrderingQueue) {
+    int nItems = 2000000;
+    optionalGlobalArg("nItems", nItems, "number of items per test");
+
+    std::mt19937 rng(12345);
+    vector<OQItem> v;
+    v.reserve(nItems);
+
+    printf("rate [Hz]\tdisorder [s]\tqueue depth\tpriority_queue [ns/item]\tcalendar [ns/item]\n");
+    for(double rate: {1e4, 1e6, 1e8}) {
+        for(double disorder: {1e-6, 1e-4, 1e-2}) {
+            // times in ns, uniformly jittered by up to "disorder"
+            std::uniform_real_distribution<double> jitter(0, 1e9 * disorder);
+            v.clear();
+            for(int i = 0; i < nItems; ++i) v.emplace_back(1e9 * i / rate + jitter(rng), i);
+
+            size_t nd0 = 0, nd1 = 0;
+            auto t0 = benchQueue<OrderingQueue<OQItem>>(v, 1e9 * disorder, nd0);
+            auto t1 = benchQueue<CalendarOrderingQueue<OQItem>>(v, 1e9 * disorder, nd1);
+            printf("%g\t\t%g\t\t%g\t\t%.1f\t\t\t\t%.1f\n", rate, disorder, rate * disorder, t0, t1);
+            if(nd0 || nd1) printf(TERMFG_RED "*** %zu, %zu disordered/missing outputs!" TERMSGR_RESET "\n", nd0, nd1);
+        }
+    }
+}
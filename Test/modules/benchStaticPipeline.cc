@@ -0,0 +1,116 @@
+/// @file benchStaticPipeline.cc Compare fused StaticPipeline against equivalent virtual-dispatch chain
+
+#include "StaticPipeline.hh"
+#include "OrderingQueue.hh"
+#include "GlobalArgs.hh"
+#include "Stopwatch.hh"
+#include <random>
+
+/// detector hit test item
+struct SPHit {
+    typedef double ordering_t;  ///< ordering type
+    double t;                   ///< time
+    double E;                   ///< energy
+    int ch;                     ///< channel
+    /// get ordering value
+    explicit operator ordering_t() const { return t; }
+};
+
+/// threshold cut
+struct SPThreshold {
+    /// select above threshold
+    bool operator()(const SPHit& h) const { return h.E > 0.05; }
+};
+/// per-channel energy calibration
+struct SPCalibrate {
+    /// apply gain, offset
+    SPHit operator()(const SPHit& h) const { return {h.t, 1.02 * h.E + 0.001 * h.ch, h.ch}; }
+};
+/// channel veto
+struct SPVeto {
+    /// reject vetoed channel
+    bool operator()(const SPHit& h) const { return h.ch != 7; }
+};
+
+/// threshold stage
+typedef StaticFilter<const SPHit, SPThreshold> SPThresholdStage;
+/// calibration stage
+typedef StaticTransform<const SPHit, const SPHit, SPCalibrate> SPCalibrateStage;
+/// veto stage
+typedef StaticFilter<const SPHit, SPVeto> SPVetoStage;
+
+/// Sum output energy
+class SPSumSink: public DataSink<const SPHit> {
+public:
+    /// accumulate
+    void push(const SPHit& h) override { sumE += h.E; ++n; }
+    double sumE = 0;    ///< summed energy
+    size_t n = 0;       ///< items received
+};
+
+/// fused filter, calibrate, veto chain
+REGISTER_PIPELINE(SPFused, SPThresholdStage, SPCalibrateStage, SPVetoStage, SPSumSink)
+/// fused chain including an ordering queue
+typedef StaticPipeline<SPThresholdStage, SPCalibrateStage, OrderingQueue<const SPHit>, SPVetoStage, SPSumSink> SPFusedOQ;
+
+/// time pushing input; return ns per item
+double timeChain(DataSink<const SPHit>& C, const vector<SPHit>& v, bool batch) {
+    Stopwatch w;
+    C.signal(DATASTREAM_INIT);
+    if(batch) for(size_t i = 0; i < v.size(); i += 256) C.push_batch({const_cast<SPHit*>(v.data()) + i, std::min<size_t>(256, v.size() - i)});
+    else for(auto h: v) C.push(h);
+    C.signal(DATASTREAM_END);
+    w.stop();
+    return 1e9 * w.elapsed / v.size();
+}
+
+/// build equivalent dynamically-linked chain, optionally with ordering queue
+DataSink<const SPHit>* dynamicChain(SPSumSink*& S, bool withOQ) {
+    auto T = new StageLink<SPThresholdStage>();
+    auto C = new StageLink<SPCalibrateStage>();
+    auto V = new StageLink<SPVetoStage>();
+    T->setNext(C);
+    if(withOQ) {
+        auto Q = new OrderingQueue<const SPHit>(nullptr, 1.);
+        C->setNext(Q);
+        Q->setNext(V);
+    } else C->setNext(V);
+    V->setNext(S = new SPSumSink());
+    return T;
+}
+
+REGISTER_EXECLET(benchStaticPipeline) {
+    int nItems = 5000000;
+    optionalGlobalArg("nItems", nItems, "number of items per test");
+
+    std::mt19937 rng(12345);
+    std::uniform_real_distribution<double> u(0, 1);
+    vector<SPHit> v(nItems);
+    for(int i = 0; i < nItems; ++i) v[i] = {i + 0.5 * u(rng), u(rng), int(16 * u(rng))};
+
+    printf("chain\t\t\t\tsingle [ns/item]\tbatch [ns/item]\tsum E\n");
+    for(bool withOQ: {false, true}) {
+        for(int k = 0; k < 2; ++k) {
+            SPSumSink* S = nullptr;
+            DataSink<const SPHit>* C = nullptr;
+            if(k) {
+                if(withOQ) {
+                    auto P = new SPFusedOQ();
+                    P->get<2>().dt = 1.;
+                    S = &P->get<4>();
+                    C = P;
+                } else {
+                    auto P = BaseFactory<DataSink<const SPHit>>::construct("SPFused", NullSetting());
+                    S = &static_cast<SPFused*>(P)->get<3>();
+                    C = P;
+                }
+            } else C = dynamicChain(S, withOQ);
+
+            auto t0 = timeChain(*C, v, false);
+            auto E0 = S->sumE;
+            auto t1 = timeChain(*C, v, true);
+            printf("%s%s\t\t%.2f\t\t\t%.2f\t\t%.6g\n", k? "fused" : "dynamic", withOQ? " + OrderingQueue" : "\t\t", t0, t1, E0);
+            delete C;
+        }
+    }
+}
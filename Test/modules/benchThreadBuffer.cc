@@ -0,0 +1,56 @@
+/// @file benchThreadBuffer.cc Compare ThreadBufferSink transport throughput and handoff latency
+
+#include "ThreadBufferSink.hh"
+#include "GlobalArgs.hh"
+#include "Stopwatch.hh"
+#include <algorithm>
+
+/// time-stamped test item
+struct StampedItem {
+    Stopwatch::timept_t t;  ///< time pushed into buffer
+    double payload[4];      ///< dummy contents
+};
+
+/// Collect handoff latencies
+class LatencySink: public DataSink<StampedItem> {
+public:
+    /// record latency
+    void push(StampedItem& o) override {
+        if(!(n++ % decimate)) dt.push_back(Stopwatch::dtime(o.t, Stopwatch::now()));
+    }
+    size_t n = 0;           ///< number of items received
+    size_t decimate = 16;   ///< latency sampling decimation
+    vector<double> dt;      ///< sampled latencies [s]
+};
+
+/// run one transport mode
+void benchTransport(ThreadBufferSink<StampedItem>::transport_t tp, size_t nItems) {
+    ThreadBufferSink<StampedItem> TBS(NullSetting());
+    TBS.transport = tp;
+    auto LS = new LatencySink();
+    TBS.setNext(LS);
+
+    StampedItem o{};
+    Stopwatch w;
+    TBS.signal(DATASTREAM_INIT);
+    for(size_t i = 0; i < nItems; ++i) {
+        o.t = Stopwatch::now();
+        o.payload[0] = i;
+        TBS.push(o);
+    }
+    TBS.signal(DATASTREAM_END);
+    w.stop();
+
+    auto& v = LS->dt;
+    std::sort(v.begin(), v.end());
+    printf("%s transport: %zu items in %g s: %.3g events/s; handoff latency median %.3g us, p99 %.3g us\n",
+           tp == TBS.TRANSPORT_RING? "ring" : "pingpong", LS->n, w.elapsed, LS->n / w.elapsed,
+           v.size()? 1e6 * v[v.size()/2] : 0., v.size()? 1e6 * v[(99 * v.size())/100] : 0.);
+}
+
+REGISTER_EXECLET(benchThreadBuffer) {
+    int nItems = 1000000;
+    optionalGlobalArg("nItems", nItems, "number of items to push");
+    benchTransport(ThreadBufferSink<StampedItem>::TRANSPORT_PINGPONG, nItems);
+    benchTransport(ThreadBufferSink<StampedItem>::TRANSPORT_RING, nItems);
+}
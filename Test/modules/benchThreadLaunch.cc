@@ -0,0 +1,49 @@
+/// @file benchThreadLaunch.cc Compare Threadworker launch/finish cost on dedicated versus pooled threads
+
+#include "ThreadBufferSink.hh"
+#include "WorkerThreadPool.hh"
+#include "GlobalArgs.hh"
+#include "Stopwatch.hh"
+
+/// Count received items
+class CountSink: public DataSink<const int> {
+public:
+    /// count item
+    void push(const int&) override { ++n; }
+    size_t n = 0;   ///< items received
+};
+
+/// run nSeg short segments through a ThreadBufferSink, launching and finishing its thread for each; return us per segment
+double benchSegments(bool pooled, int nSeg, int nPer, size_t& nrecv) {
+    ThreadBufferSink<const int> TBS(NullSetting());
+    TBS.pooled = pooled;
+    auto CS = new CountSink();
+    TBS.setNext(CS);
+
+    Stopwatch w;
+    for(int s = 0; s < nSeg; ++s) {
+        TBS.signal(DATASTREAM_INIT);
+        for(int i = 0; i < nPer; ++i) TBS.push(i);
+        TBS.signal(DATASTREAM_END);
+    }
+    w.stop();
+    nrecv = CS->n;
+    return 1e6 * w.elapsed / nSeg;
+}
+
+REGISTER_EXECLET(benchThreadLaunch) {
+    int nSeg = 2000;
+    optionalGlobalArg("nSeg", nSeg, "number of launch/finish segments");
+    int nPer = 1;
+    optionalGlobalArg("nPer", nPer, "items per segment");
+
+    for(bool pooled: {false, true}) {
+        size_t n = 0;
+        auto dt = benchSegments(pooled, nSeg, nPer, n);
+        printf("%s threads: %i segments x %i items in %.1f us/segment (%zu received)\n",
+               pooled? "pooled" : "dedicated", nSeg, nPer, dt, n);
+        if(n != size_t(nSeg) * nPer) throw std::logic_error("items lost between segments");
+    }
+    auto& P = WorkerThreadPool::global();
+    printf("pool: %zu threads spawned, %zu re-used\n", P.n_spawned.load(), P.n_reused.load());
+}
@@ -0,0 +1,156 @@
+/// @file testCheckpoint.cc Resume analysis chain from mid-stream checkpoint, compared to uninterrupted run
+
+#include "ClusteredWindow.hh"
+#include "OrderingQueue.hh"
+#include "DataSource.hh"
+#include "HDF5_Table_Cache.hh"
+#include "MemBIO.hh"
+#include "ConfigFactory.hh"
+#include "GlobalArgs.hh"
+#include "TermColor.hh"
+#include <random>
+#include <cstdio>
+#include <cstddef> // for offsetof
+
+/// time-ordered test item
+struct CkItem {
+    typedef double ordering_t;  ///< ordering type
+    double t;                   ///< ordering value
+    int i;                      ///< item number
+    /// get ordering value
+    explicit operator ordering_t() const { return t; }
+
+    /// HDF5 table layout
+    static HDF5_Table_Spec HDF5_table_setup(const string& tname, int) {
+        static const size_t offsets[] = { offsetof(CkItem, t), offsetof(CkItem, i) };
+        static const size_t sizes[] = { sizeof(double), sizeof(int) };
+        static const hid_t types[] = { H5T_NATIVE_DOUBLE, H5T_NATIVE_INT };
+        static const char* names[] = { "t", "i" };
+        HDF5_Table_Spec S;
+        S.n_fields = 2;
+        S.struct_size = sizeof(CkItem);
+        S.offsets = offsets;
+        S.field_sizes = sizes;
+        S.field_types = types;
+        S.field_names = names;
+        S.table_name = tname.size()? tname : "CkItem";
+        S.table_descrip = "checkpoint test items";
+        return S;
+    }
+};
+/// cluster of test items
+typedef Cluster<CkItem> CkCluster;
+
+/// Replay of input vector
+class VecSource: public DataSource<CkItem> {
+public:
+    /// Constructor
+    explicit VecSource(const vector<CkItem>& _v): v(_v) { }
+    /// get next item
+    bool next(CkItem& o) override {
+        if(nread >= v.size()) return false;
+        o = v[nread++];
+        return true;
+    }
+    /// number of items
+    size_t entries() const override { return v.size(); }
+    const vector<CkItem>& v;    ///< input items
+};
+
+/// Record clusters passing through window middle
+class RecordingWindow: public ClusteredWindow<CkCluster> {
+public:
+    /// Constructor
+    RecordingWindow(): ClusteredWindow<CkCluster>(20., 1.) { }
+    vector<std::pair<double, size_t>> mids; ///< (median, size) of clusters through middle
+protected:
+    /// record mid cluster
+    void processMid(CkCluster& C) override { mids.emplace_back(double(C), C.size()); }
+};
+
+/// run chain over input source, optionally checkpointing after nCk items or resuming from checkpoint file
+vector<std::pair<double, size_t>> runChain(DataSource<CkItem>& src, const string& f, size_t nCk, bool resume) {
+    src.reset();
+    auto W = new RecordingWindow();
+    OrderingQueue<const CkItem> OQ(W, 3.);
+    ChainCheckpoint CP(f);
+    CP.add(src, "source");
+    CP.add(OQ, "queue");
+    CP.add(*W, "window");
+    if(resume && !CP.resume()) throw std::runtime_error("Missing checkpoint file '" + f + "'");
+
+    OQ.signal(DATASTREAM_INIT);
+    if(nCk) {
+        if(pumpSource(src, OQ, nCk) != nCk) throw std::logic_error("Source ended before checkpoint");
+        CP.request(src, OQ);
+    }
+    pumpSource(src, OQ);
+    OQ.signal(DATASTREAM_END);
+    CP.finish();
+    return W->mids;
+}
+
+/// compare uninterrupted, checkpointed, and resumed runs over source; return uninterrupted output
+vector<std::pair<double, size_t>> checkResume(DataSource<CkItem>& src, const string& f, const string& desc) {
+    auto A = runChain(src, f, 0, false);                        // uninterrupted
+    auto B = runChain(src, f, src.entries() / 2, false);        // checkpointed mid-way
+    auto C = runChain(src, f, 0, true);                         // resumed from checkpoint
+    std::remove(f.c_str());
+
+    size_t k = A.size() - C.size();
+    bool ok = A == B && C.size() < A.size() && std::equal(C.begin(), C.end(), A.begin() + k);
+    printf("%s: %zu clusters uninterrupted, %zu checkpointed, %zu after resume\n", desc.c_str(), A.size(), B.size(), C.size());
+    if(!ok) throw std::logic_error(desc + ": resumed chain output mismatch");
+    return A;
+}
+
+REGISTER_EXECLET(testCheckpoint) {
+    int nItems = 100000;
+    optionalGlobalArg("nItems", nItems, "number of input items");
+    string f = "testCheckpoint.ckpt";
+    optionalGlobalArg("ckpt", f, "checkpoint file name");
+
+    // clusters of items spaced by 0.1--0.5, clusters spaced by 2--20, jittered in arrival order by up to 2
+    std::mt19937 rng(12345);
+    std::uniform_real_distribution<double> u(0, 1);
+    vector<CkItem> v;
+    double t = 0;
+    for(int i = 0; i < nItems; ++i) {
+        t += u(rng) < 0.2? 2 + 18 * u(rng) : 0.1 + 0.4 * u(rng);
+        v.push_back({t, i});
+    }
+    for(size_t i = 0; i + 1 < v.size(); ++i) if(u(rng) < 0.3 && v[i+1].t - v[i].t < 2) std::swap(v[i], v[i+1]);
+
+    VecSource VS(v);
+    auto A = checkResume(VS, f, "vector source");
+
+    // chunk-cached source: checkpoint position must exclude rows cached but not yet consumed
+    string fh = f + ".h5";
+    {
+        HDF5_Table_Writer<CkItem> TW("CkItem", 0, 1000, 0);
+        TW.openOutput(fh);
+        TW.initTable();
+        TW.push(v);
+        TW.signal(DATASTREAM_END);
+        TW.writeFile();
+    }
+    HDF5_Table_Cache<CkItem> TC("CkItem", 0, 777);  // checkpoint falls mid-chunk
+    TC.openInput(fh);
+    if(checkResume(TC, f, "HDF5 chunk-cached source") != A) throw std::logic_error("HDF5 chunk batches: chain output differs from vector source");
+    std::remove(fh.c_str());
+
+    // restoring into a non-empty queue replaces its contents
+    {
+        auto W = new RecordingWindow();
+        OrderingQueue<const CkItem> OQ(W, 1e9);
+        OQ.signal(DATASTREAM_INIT);
+        for(size_t i = 0; i < 10; ++i) OQ.push(v[i]);
+        DequeBIO D;
+        OQ.saveState(D);
+        OQ.restoreState(D);
+        if(OQ.size() != 10) throw std::logic_error("OrderingQueue restore duplicated queued items");
+        OQ.signal(DATASTREAM_END);
+    }
+
+    printf(TERMFG_GREEN "Resumed output matches uninterrupted run." TERMSGR_RESET "\n");
+}
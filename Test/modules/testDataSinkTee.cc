@@ -0,0 +1,110 @@
+/// @file testDataSinkTee.cc Stream order of interleaved data and signals through threaded DataSinkTee branches
+
+#include "DataSinkTee.hh"
+#include "GlobalArgs.hh"
+#include "TermColor.hh"
+#include <random>
+#include <thread>
+#include <chrono>
+
+/// test item
+struct TeeItem {
+    int i;  ///< item number
+};
+
+/// Record stream of items (as number) and signals (as -signal) received
+template<typename T>
+class TeeRecorder: public DataSink<T> {
+public:
+    /// Constructor
+    explicit TeeRecorder(const Setting& S) {
+        SettingsQuery Cfg(S);
+        Cfg.markused("class");
+        Cfg.lookupValue("delay_us", delay_us, "delay per received batch [us]");
+        made().push_back(this);
+    }
+    /// record item
+    void push(T& x) override { log.push_back(x.i); }
+    /// record batch, with optional delay for slow-branch testing
+    void push_batch(typename DataSink<T>::span_t v) override {
+        if(delay_us) std::this_thread::sleep_for(std::chrono::microseconds(delay_us));
+        for(auto& x: v) log.push_back(x.i);
+    }
+    /// record signal
+    void signal(datastream_signal_t s) override { log.push_back(-int(s)); }
+
+    vector<int> log;    ///< received stream
+    int delay_us = 0;   ///< delay per received batch
+
+    /// instances, in construction order
+    static vector<TeeRecorder*>& made() { static vector<TeeRecorder*> v; return v; }
+};
+
+/// recording sink for immutable items
+typedef TeeRecorder<const TeeItem> TeeRecorderC;
+REGISTER_CONFIG(TeeRecorderC, DataSink<const TeeItem>)
+/// recording sink for mutable items
+typedef TeeRecorder<TeeItem> TeeRecorderM;
+REGISTER_CONFIG(TeeRecorderM, DataSink<TeeItem>)
+
+/// push interleaved items, batches and signals through threaded tee; check each branch receives input stream in order
+template<typename T>
+void checkTee(const string& rclass, int nItems) {
+    Config cfg;
+    auto& S = cfg.getRoot();
+    S.add("threaded", Setting::TypeBoolean) = true;
+    S.add("batch", Setting::TypeInt) = 7;
+    auto& nxt = S.add("next", Setting::TypeList);
+    for(int i = 0; i < 3; ++i) {
+        auto& n = nxt.add(Setting::TypeGroup);
+        n.add("class", Setting::TypeString) = rclass;
+        if(i == 1) n.add("delay_us", Setting::TypeInt) = 50;   // slow branch falling behind
+    }
+    auto& BS = S.add("branches", Setting::TypeList);
+    BS.add(Setting::TypeGroup).add("capacity", Setting::TypeInt) = 2;   // small blocking queue on first branch
+
+    TeeRecorder<T>::made().clear();
+    DataSinkTee<T> Tee(S);
+
+    vector<int> expect;
+    auto sig = [&](datastream_signal_t s) { Tee.signal(s); expect.push_back(-int(s)); };
+
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> u(0, 99);
+    sig(DATASTREAM_INIT);
+    sig(DATASTREAM_START);
+    vector<typename std::remove_const<T>::type> b;
+    int i = 0;
+    while(i < nItems) {
+        auto r = u(rng);
+        if(r < 5) sig(r < 2? DATASTREAM_FLUSH : DATASTREAM_CHECKPT);
+        else if(r < 30) {   // batch push
+            b.clear();
+            for(int k = 0; k < 1 + r && i < nItems; ++k) {
+                b.push_back({i});
+                expect.push_back(i++);
+            }
+            Tee.push_batch(b);
+        } else {            // single push
+            typename std::remove_const<T>::type x{i};
+            Tee.push(x);
+            expect.push_back(i++);
+        }
+    }
+    sig(DATASTREAM_END);    // completes and joins branch threads
+
+    auto& R = TeeRecorder<T>::made();
+    if(R.size() != 3) throw std::logic_error("Unexpected number of tee branches");
+    for(size_t j = 0; j < R.size(); ++j)
+        if(R[j]->log != expect) throw std::logic_error(rclass + ": branch " + std::to_string(j) + " stream out of order");
+    printf("%s: %zu items and signals in order on each of %zu branches.\n", rclass.c_str(), expect.size(), R.size());
+}
+
+REGISTER_EXECLET(testDataSinkTee) {
+    int nItems = 20000;
+    optionalGlobalArg("nItems", nItems, "number of items pushed");
+
+    checkTee<const TeeItem>("TeeRecorderC", nItems);
+    checkTee<TeeItem>("TeeRecorderM", nItems);
+    printf(TERMFG_GREEN "DataSinkTee threaded ordering checks passed." TERMSGR_RESET "\n");
+}
@@ -0,0 +1,142 @@
+/// @file testDataSourceMerge.cc Merged-order output of DataSourceMerge, via next() and next_batch()
+
+#include "DataSourceMerge.hh"
+#include "HDF5_Table_Cache.hh"
+#include "ConfigFactory.hh"
+#include "GlobalArgs.hh"
+#include "TermColor.hh"
+#include <random>
+#include <algorithm>
+#include <cstdio>
+#include <deque>
+#include <cstdlib>
+#include <cstddef> // for offsetof
+#include <unistd.h>
+
+/// time-ordered test item
+struct MgItem {
+    typedef double ordering_t;  ///< ordering type
+    double t;                   ///< ordering value
+    int src;                    ///< source stream
+    /// get ordering value
+    explicit operator ordering_t() const { return t; }
+
+    /// HDF5 table layout
+    static HDF5_Table_Spec HDF5_table_setup(const string& tname, int) {
+        static const size_t offsets[] = { offsetof(MgItem, t), offsetof(MgItem, src) };
+        static const size_t sizes[] = { sizeof(double), sizeof(int) };
+        static const hid_t types[] = { H5T_NATIVE_DOUBLE, H5T_NATIVE_INT };
+        static const char* names[] = { "t", "src" };
+        HDF5_Table_Spec S;
+        S.n_fields = 2;
+        S.struct_size = sizeof(MgItem);
+        S.offsets = offsets;
+        S.field_sizes = sizes;
+        S.field_types = types;
+        S.field_names = names;
+        S.table_name = tname.size()? tname : "MgItem";
+        S.table_descrip = "merge test items";
+        return S;
+    }
+};
+
+/// Replay of input vector, with its own next_batch (as e.g. HDF5_Table_Cache)
+class BatchVecSource: public DataSource<MgItem> {
+public:
+    /// Default constructor
+    BatchVecSource() { }
+    /// Constructor
+    explicit BatchVecSource(const vector<MgItem>& _v): v(_v) { }
+    /// get next item
+    bool next(MgItem& o) override {
+        if(nread >= v.size()) return false;
+        o = v[nread++];
+        return true;
+    }
+    /// view of next items directly from input vector
+    span_view<MgItem> next_batch(size_t nmax) override {
+        size_t n = std::min(nmax, v.size() - nread);
+        span_view<MgItem> s(v.data() + nread, n);
+        nread += n;
+        return s;
+    }
+    /// number of items
+    size_t entries() const override { return v.size(); }
+    vector<MgItem> v;   ///< input items
+};
+
+/// check merged output is complete and ordered
+static void checkMerged(const vector<MgItem>& o, size_t n, const char* path) {
+    if(o.size() != n) throw std::logic_error(string(path) + ": wrong number of merged items");
+    for(size_t i = 1; i < o.size(); ++i)
+        if(o[i].t < o[i-1].t) throw std::logic_error(string(path) + ": merged output out of order");
+    printf("%s: %zu items merged in order.\n", path, o.size());
+}
+
+REGISTER_EXECLET(testDataSourceMerge) {
+    int nStreams = 5;
+    optionalGlobalArg("nStreams", nStreams, "number of merged streams");
+    int nItems = 10000;
+    optionalGlobalArg("nItems", nItems, "items per stream");
+
+    std::mt19937 rng(1);
+    std::exponential_distribution<double> dt(1.);
+    vector<BatchVecSource> S(nStreams);
+    for(int s = 0; s < nStreams; ++s) {
+        double t = 0;
+        for(int i = 0; i < nItems; ++i) S[s].v.push_back({t += dt(rng), s});
+    }
+    size_t n = size_t(nStreams) * nItems;
+
+    DataSourceMerge<BatchVecSource> M;
+    M.nbatch = 100;
+    for(auto& s: S) M.addStream(s);
+
+    vector<MgItem> o;
+    MgItem x;
+    while(M.next(x)) o.push_back(x);
+    checkMerged(o, n, "next()");
+
+    // batch path must go through the merge, not the (empty) BatchVecSource base of the merge object
+    M.reset();
+    o.clear();
+    while(true) {
+        auto b = M.next_batch(777);
+        if(!b.size()) break;
+        o.insert(o.end(), b.begin(), b.end());
+    }
+    checkMerged(o, n, "next_batch()");
+    if(M.getNRead() != n) throw std::logic_error("next_batch() read count mismatch");
+
+    // HDF5 files read concurrently by merge prefetch; inputs written to (and removed from) a temporary directory
+    const char* tmp = getenv("TMPDIR");
+    string dtemplate = string(tmp && *tmp? tmp : "/tmp") + "/testDataSourceMerge_XXXXXX";
+    if(!mkdtemp(&dtemplate[0])) throw std::runtime_error("Failed to create temporary directory");
+    vector<string> fnames;
+    for(int s = 0; s < nStreams; ++s) {
+        fnames.push_back(dtemplate + "/m" + std::to_string(s) + ".h5");
+        HDF5_Table_Writer<MgItem> TW("MgItem", 0, 1000, 0);
+        TW.openOutput(fnames.back());
+        TW.initTable();
+        TW.push(S[s].v);
+        TW.signal(DATASTREAM_END);
+        TW.writeFile();
+    }
+    {
+        std::deque<HDF5_Table_Cache<MgItem>> HS;    // not movable
+        DataSourceMerge<HDF5_Table_Cache<MgItem>> HM("MgItem", 0);
+        HM.nbatch = 100;
+        for(auto& f: fnames) {
+            HS.emplace_back("MgItem", 0, 512);
+            HS.back().deferInput(f);
+            HM.addStream(HS.back());
+        }
+        o.clear();
+        while(HM.next(x)) o.push_back(x);
+        checkMerged(o, n, "HDF5 next()");
+    }
+    for(auto& f: fnames) std::remove(f.c_str());
+    rmdir(dtemplate.c_str());
+
+    printf(TERMFG_GREEN "DataSourceMerge checks passed." TERMSGR_RESET "\n");
+}
@@ -0,0 +1,169 @@
+/// @file testPrefetchingSource.cc Read-ahead stream consistency for PrefetchingSource and prefetching DataSourceSeq
+
+#include "PrefetchingSource.hh"
+#include "ConfigFactory.hh"
+#include "GlobalArgs.hh"
+#include "TermColor.hh"
+#include <atomic>
+#include <deque>
+
+/// numbered test item
+struct PfItem {
+    size_t i;   ///< position in stream
+};
+
+/// Numbered sequence source, optionally failing at a read position or on prefetch
+class SeqNumSource: public DataSource<PfItem> {
+public:
+    /// Constructor, with starting number and length
+    explicit SeqNumSource(size_t _i0 = 0, size_t _n = 0): i0(_i0), nitems(_n) { }
+    /// get next item
+    bool next(PfItem& o) override {
+        if(nread >= failAt) throw std::runtime_error("SeqNumSource read failure");
+        if(nread >= nitems) return false;
+        o.i = i0 + nread++;
+        return true;
+    }
+    /// skip ahead k items
+    bool skip(size_t k) override {
+        if(nread + k > nitems) return false;
+        nread += k;
+        return true;
+    }
+    /// number of items
+    size_t entries() const override { return nitems; }
+    /// count (or fail) prefetch
+    void prefetch() override {
+        ++nprefetch;
+        if(failPrefetch) throw std::runtime_error("SeqNumSource prefetch failure");
+    }
+
+    size_t i0;                      ///< first item number
+    size_t nitems;                  ///< number of items
+    size_t failAt = max_entries;    ///< read position to throw at
+    bool failPrefetch = false;      ///< whether to throw on prefetch
+    std::atomic<int> nprefetch{0};  ///< number of prefetch() calls
+};
+
+/// read whole stream through next() or next_batch(); check numbering from 0
+template<class DS>
+size_t readChecked(DS& S, bool batched, const char* what) {
+    size_t n = 0;
+    auto check = [&n, what](const PfItem& x) {
+        if(x.i != n++) throw std::logic_error(string(what) + ": items out of order");
+    };
+    if(batched) {
+        while(true) {
+            auto b = S.next_batch(333);
+            if(!b.size()) break;
+            for(auto& x: b) check(x);
+        }
+        if(S.next_batch(333).size()) throw std::logic_error(string(what) + ": data after end of stream");
+    } else {
+        PfItem x;
+        while(S.next(x)) check(x);
+        if(S.next(x)) throw std::logic_error(string(what) + ": data after end of stream");
+    }
+    if(S.getNRead() != n) throw std::logic_error(string(what) + ": read count mismatch");
+    printf("%s: %zu items in order.\n", what, n);
+    return n;
+}
+
+/// Sink checking looped stream numbering (0 ... n-1, 0 ...) and counting batches
+class PfLoopSink: public DataSink<const PfItem> {
+public:
+    /// Constructor, with stream length
+    explicit PfLoopSink(size_t _n): n(_n) { }
+    /// check item
+    void push(const PfItem& x) override {
+        if(x.i != nrecv++ % n) throw std::logic_error("pumpSource: items out of order");
+    }
+    /// check batch
+    void push_batch(span_t v) override {
+        ++nbatch;
+        for(auto& x: v) push(x);
+    }
+    /// no signals expected from pump
+    void signal(datastream_signal_t) override { throw std::logic_error("pumpSource: unexpected signal"); }
+
+    size_t n;           ///< stream length
+    size_t nrecv = 0;   ///< items received
+    size_t nbatch = 0;  ///< batches received
+};
+
+/// expect read to throw after exactly n items
+template<class DS>
+void readFailing(DS& S, size_t n, const char* what) {
+    size_t k = 0;
+    PfItem x;
+    try {
+        while(S.next(x)) {
+            if(x.i != k++) throw std::logic_error(string(what) + ": items out of order");
+        }
+    } catch(std::runtime_error& e) {
+        if(k != n) throw std::logic_error(string(what) + ": items before failure lost or duplicated");
+        printf("%s: %zu items, then '%s'\n", what, k, e.what());
+        return;
+    }
+    throw std::logic_error(string(what) + ": failure not propagated");
+}
+
+REGISTER_EXECLET(testPrefetchingSource) {
+    int nItems = 10000;
+    optionalGlobalArg("nItems", nItems, "items per stream");
+    const size_t n = nItems;
+
+    {
+        SeqNumSource S(0, n);
+        PrefetchingSource<SeqNumSource> P(S, 100, 3);
+        if(readChecked(P, false, "Prefetching next()") != n) throw std::logic_error("Prefetching: wrong item count");
+        P.reset();
+        if(readChecked(P, true, "Prefetching next_batch()") != n) throw std::logic_error("Prefetching: wrong item count after reset");
+
+        P.reset();
+        if(!P.skip(n/2 + 7)) throw std::logic_error("Prefetching: skip failed");
+        PfItem x;
+        if(!P.next(x) || x.i != n/2 + 7) throw std::logic_error("Prefetching: wrong item after skip");
+
+        // items from batches completed before failure are delivered, then the error
+        P.reset();
+        S.failAt = n/2;
+        readFailing(P, n/2, "Prefetching failure");
+        S.failAt = SeqNumSource::max_entries;
+        P.reset();
+        if(readChecked(P, false, "Prefetching after failure reset") != n) throw std::logic_error("Prefetching: error not cleared by reset");
+
+        // batches fed to sink, looping over stream
+        P.reset();
+        P.doLoop = true;
+        PfLoopSink L(n);
+        size_t nmax = 5*n/2;
+        if(pumpSource(P, L, nmax, 100) != nmax || L.nrecv != nmax) throw std::logic_error("pumpSource: wrong item count");
+        if(L.nbatch > nmax/100 + 3) throw std::logic_error("pumpSource: items not fed in batches");
+        printf("pumpSource: %zu looped items in %zu batches.\n", L.nrecv, L.nbatch);
+        P.doLoop = false;
+    }
+
+    {
+        const int nsrc = 4;
+        std::deque<SeqNumSource> S;    // not movable
+        for(int j = 0; j < nsrc; ++j) S.emplace_back(j*n, n);
+        DataSourceSeq<SeqNumSource> Q;
+        Q.prefetchNext = true;
+        for(auto& s: S) Q.addStream(s);
+
+        if(readChecked(Q, false, "Seq prefetch next()") != nsrc*n) throw std::logic_error("Seq: wrong item count");
+        for(auto& s: S) if(s.nprefetch != 1) throw std::logic_error("Seq: each source should be prefetched once");
+        Q.reset();
+        if(readChecked(Q, true, "Seq prefetch next_batch()") != nsrc*n) throw std::logic_error("Seq: wrong item count after reset");
+
+        Q.reset();
+        S[2].failPrefetch = true;
+        readFailing(Q, 2*n, "Seq prefetch failure");
+        S[2].failPrefetch = false;
+        Q.reset();
+        if(readChecked(Q, false, "Seq after failure reset") != nsrc*n) throw std::logic_error("Seq: wrong item count after failure");
+    }
+
+    printf(TERMFG_GREEN "PrefetchingSource checks passed." TERMSGR_RESET "\n");
+}
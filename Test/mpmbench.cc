@@ -0,0 +1,379 @@
+/// @file mpmbench.cc Throughput benchmarks of Framework data-flow stages on synthetic event streams
+
+/*
+bin/mpmbench -nEvents 2000000 -rate 1e6 -jitter 1e-6 -multiplicity 4 -payload 64 -topology all -json bench.json
+*/
+
+#include "ClusteredWindow.hh"
+#include "OrderingQueue.hh"
+#include "MergeCollator.hh"
+#include "ConfigParallel.hh"
+#include "ProfilingSink.hh"
+#include "OrderedData.hh"
+#include "GlobalArgs.hh"
+#include "CodeVersion.hh"
+#include "StringManip.hh"
+#include "Stopwatch.hh"
+#include "TermColor.hh"
+#include "CountingAlloc.hh"
+#include <random>
+#include <thread>
+#include <fstream>
+#include <sstream>
+#include <atomic>
+#include <cstdlib>
+#include <cstdint>
+
+/// reset peak resident set size (Linux >= 4.0; ignored elsewhere)
+void resetPeakRSS() {
+    std::ofstream f("/proc/self/clear_refs");
+    f << "5";
+}
+
+/// peak resident set size since last reset [kB]
+size_t peakRSS() {
+    std::ifstream f("/proc/self/status");
+    string l;
+    while(std::getline(f, l)) if(!l.compare(0, 6, "VmHWM:")) return std::stoul(l.substr(6));
+    return 0;
+}
+
+//-----------------------------
+// synthetic events
+
+/// Detector hit payload, padded to N bytes
+template<size_t N>
+struct BenchPayload {
+    uint32_t ch = 0;        ///< channel
+    float E = 0;            ///< energy
+    char pad[N - 8] = {};   ///< remaining payload
+};
+
+/// Synthetic event stream parameters
+struct SyntheticParams {
+    size_t nEvents = 1000000;   ///< number of events
+    double rate = 1e6;          ///< mean event rate [1/s]
+    double jitter = 1e-6;       ///< maximum arrival-order disorder [s]
+    double multiplicity = 4;    ///< mean events per time-correlated cluster
+    int payload = 16;           ///< event payload size [bytes]
+
+    /// mean spacing between clusters [s]
+    double clusterSpacing() const { return multiplicity / rate; }
+    /// clustering time window [s]
+    double clusterDt() const { return 0.1 * clusterSpacing(); }
+};
+
+/// Generate time-ordered events in clusters, with arrival order jittered by up to P.jitter
+template<class E>
+vector<E> generateEvents(const SyntheticParams& P, uint32_t seed = 12345) {
+    std::mt19937 rng(seed);
+    std::exponential_distribution<double> gap(1. / P.clusterSpacing());
+    std::exponential_distribution<double> inner(1e3 / P.clusterSpacing());
+    std::poisson_distribution<int> mult(std::max(P.multiplicity - 1, 0.));
+    std::uniform_real_distribution<double> u(0, 1);
+
+    vector<std::pair<double, E>> v;
+    v.reserve(P.nEvents);
+    double t = 0;
+    while(v.size() < P.nEvents) {
+        t += gap(rng);
+        double tc = t;
+        for(int i = mult(rng) + 1; i > 0 && v.size() < P.nEvents; --i) {
+            typename E::val_t x;
+            x.ch = rng() % 64;
+            x.E = u(rng);
+            v.emplace_back(tc + P.jitter * u(rng), E(tc, x));
+            tc += inner(rng);
+        }
+    }
+    std::sort(v.begin(), v.end(), [](const std::pair<double, E>& a, const std::pair<double, E>& b) { return a.first < b.first; });
+
+    vector<E> o;
+    o.reserve(v.size());
+    for(auto& p: v) o.push_back(p.second);
+    return o;
+}
+
+//-----------------------------
+// chain endpoints
+
+/// Count received items, and check their order
+template<typename T>
+class BenchCountSink: public DataSink<const T> {
+public:
+    /// Default constructor
+    BenchCountSink() { last() = this; }
+    /// Configuration constructor
+    explicit BenchCountSink(const Setting&): BenchCountSink() { }
+    /// count item
+    void push(const T& o) override {
+        auto t = double(o);
+        if(t < tprev) ++n_disordered;
+        tprev = t;
+        ++n;
+    }
+    size_t n = 0;               ///< number of items received
+    size_t n_disordered = 0;    ///< number of out-of-order items
+    double tprev = -1e99;       ///< previous item ordering
+
+    /// most recently constructed instance (for configuration-built chains)
+    static BenchCountSink*& last() { static BenchCountSink* l = nullptr; return l; }
+};
+
+/// Count clusters passing through window middle
+template<class C>
+class BenchWindow: public ClusteredWindow<C> {
+public:
+    /// Constructor
+    BenchWindow(double w, double dt): ClusteredWindow<C>(w, dt) { }
+    size_t n = 0;       ///< clusters processed
+    size_t nItems = 0;  ///< items in processed clusters
+protected:
+    /// process middle cluster
+    void processMid(C& c) override { ++n; nItems += c.size(); }
+};
+
+/// output sinks for configuration-built chains, by payload size
+typedef BenchCountSink<const OrderedData<BenchPayload<16>>> BenchCountSink16;
+REGISTER_CONFIG(BenchCountSink16, DataSink<const OrderedData<BenchPayload<16>>>)
+/// output sinks for configuration-built chains, by payload size
+typedef BenchCountSink<const OrderedData<BenchPayload<64>>> BenchCountSink64;
+REGISTER_CONFIG(BenchCountSink64, DataSink<const OrderedData<BenchPayload<64>>>)
+/// output sinks for configuration-built chains, by payload size
+typedef BenchCountSink<const OrderedData<BenchPayload<256>>> BenchCountSink256;
+REGISTER_CONFIG(BenchCountSink256, DataSink<const OrderedData<BenchPayload<256>>>)
+/// output sinks for configuration-built chains, by payload size
+typedef BenchCountSink<const OrderedData<BenchPayload<1024>>> BenchCountSink1024;
+REGISTER_CONFIG(BenchCountSink1024, DataSink<const OrderedData<BenchPayload<1024>>>)
+
+//-----------------------------
+// benchmark runs
+
+/// results for one topology
+struct BenchResult {
+    string topology;            ///< chain topology name
+    size_t nEvents = 0;         ///< events pushed
+    size_t nOut = 0;            ///< items (or clusters) out of chain
+    double seconds = 0;         ///< wall time
+    size_t peak_rss_kB = 0;     ///< peak resident set size during run
+    size_t allocs = 0;          ///< heap allocations during run
+    size_t alloc_bytes = 0;     ///< heap bytes allocated during run
+    vector<StageStats> stages;  ///< per-stage profiles
+};
+
+/// wrap stage with profiler
+template<typename T>
+DataSink<T>* profiled(DataSink<T>* S, const string& name) { return new ProfilingSink<T>(S, name); }
+
+/// time pushing events through chain (deleted after run); optional DATASTREAM_INIT for chains not launched on construction
+template<typename E>
+BenchResult timeChain(const string& topology, const vector<E>& v, DataSink<const E>* chain, const std::function<size_t()>& nOut, bool init = true) {
+    BenchResult R;
+    R.topology = topology;
+    R.nEvents = v.size();
+
+    _ProfilingSink::clearRetired();    // drop stage statistics left from previous runs
+    resetPeakRSS();
+    size_t a0 = n_allocs, b0 = alloc_bytes;
+    Stopwatch w;
+    if(init) chain->signal(DATASTREAM_INIT);
+    for(auto& o: v) chain->push(o);
+    chain->signal(DATASTREAM_END);
+    w.stop();
+
+    R.seconds = w.elapsed;
+    R.allocs = n_allocs - a0;
+    R.alloc_bytes = alloc_bytes - b0;
+    R.peak_rss_kB = peakRSS();
+    R.nOut = nOut();
+    R.stages = _ProfilingSink::allStats();
+    delete chain;
+    return R;
+}
+
+/// OrderingQueue -> output
+template<typename E>
+BenchResult benchOrdering(const SyntheticParams& P, const vector<E>& v) {
+    auto S = new BenchCountSink<E>();
+    auto Q = new OrderingQueue<const E>(profiled<const E>(S, "output"), P.jitter);
+    return timeChain<E>("ordering", v, profiled<const E>(Q, "OrderingQueue"), [S] { return S->n; });
+}
+
+/// OrderingQueue -> ClusterBuilder -> output
+template<typename E>
+BenchResult benchCluster(const SyntheticParams& P, const vector<E>& v) {
+    typedef Cluster<const E> C;
+    auto S = new BenchCountSink<C>();
+    auto B = new ClusterBuilder<const C>(P.clusterDt());
+    B->setNext(profiled<const C>(S, "output"));
+    auto Q = new OrderingQueue<const E>(profiled<const E>(B, "ClusterBuilder"), P.jitter);
+    return timeChain<E>("cluster", v, profiled<const E>(Q, "OrderingQueue"), [S] { return S->n; });
+}
+
+/// OrderingQueue -> ClusteredWindow
+template<typename E>
+BenchResult benchWindow(const SyntheticParams& P, const vector<E>& v) {
+    auto W = new BenchWindow<Cluster<const E>>(10 * P.clusterSpacing(), P.clusterDt());
+    auto Q = new OrderingQueue<const E>(profiled<const E>(W, "ClusteredWindow"), P.jitter);
+    return timeChain<E>("window", v, profiled<const E>(Q, "OrderingQueue"), [W] { return W->n; });
+}
+
+/// nInputs producer threads, each with a share of events in order -> MergeCollator -> output
+template<typename E>
+BenchResult benchCollator(const SyntheticParams&, const vector<E>& v, int nInputs) {
+    auto S = new BenchCountSink<E>();
+    MergeCollator<E> M;
+    M.setNext(profiled<const E>(S, "output"));
+    vector<DataSink<E>*> vIn;
+    for(int j = 0; j < nInputs; ++j) vIn.push_back(&M.new_input());
+
+    BenchResult R;
+    R.topology = "collator";
+    R.nEvents = v.size();
+    _ProfilingSink::clearRetired();    // drop stage statistics left from previous runs
+    resetPeakRSS();
+    size_t a0 = n_allocs, b0 = alloc_bytes;
+    Stopwatch w;
+    M.launch_mythread();
+    vector<std::thread> vt;
+    for(int j = 0; j < nInputs; ++j) {
+        vt.emplace_back([&v, &vIn, j, nInputs] {
+            for(size_t i = j; i < v.size(); i += nInputs) {
+                E o = v[i];
+                vIn[j]->push(o);
+            }
+            vIn[j]->signal(DATASTREAM_END);
+        });
+    }
+    for(auto& t: vt) t.join();
+    M.finish_mythread();
+    M.signal(DATASTREAM_END);
+    w.stop();
+
+    R.seconds = w.elapsed;
+    R.allocs = n_allocs - a0;
+    R.alloc_bytes = alloc_bytes - b0;
+    R.peak_rss_kB = peakRSS();
+    R.nOut = S->n;
+    R.stages = _ProfilingSink::allStats();
+    return R;
+}
+
+/// OrderingQueue -> ConfigParallel (cluster dispatch to threaded lanes, collated) -> output
+template<typename E>
+BenchResult benchParallel(const SyntheticParams& P, const vector<E>& v) {
+    Config cfg;
+    auto& S = cfg.getRoot();
+    S.add("cluster_dt", Setting::TypeFloat) = P.clusterDt();
+    S.add("parallel", Setting::TypeGroup);
+    S.add("next", Setting::TypeGroup).add("class", Setting::TypeString) = "BenchCountSink" + std::to_string(sizeof(typename E::val_t));
+
+    auto CP = new ConfigParallel<const E, Clusterer<const E>>(S);
+    auto Q = new OrderingQueue<const E>(profiled<const E>(CP, "ConfigParallel"), P.jitter);
+    return timeChain<E>("parallel", v, profiled<const E>(Q, "OrderingQueue"), [] {
+        auto C = BenchCountSink<const E>::last();
+        return C? C->n : 0;
+    }, false);
+}
+
+//-----------------------------
+// output
+
+/// display result summary
+void printResult(const BenchResult& R) {
+    printf(TERMSGR_BOLD "%-10s" TERMSGR_RESET " %10.4g events/s  %8.1f ns/event  %8zu out  %8.1f MB peak RSS  %6.3f allocs/event\n",
+           R.topology.c_str(), R.nEvents / R.seconds, 1e9 * R.seconds / R.nEvents, R.nOut,
+           R.peak_rss_kB / 1024., double(R.allocs) / R.nEvents);
+    for(auto& s: R.stages)
+        printf("\t%-20s %10zu items  %8.1f ns/item\n", s.name.c_str(), s.n_items, s.n_items? 1e9 * s.t_push / s.n_items : 0.);
+}
+
+/// write results as JSON
+void writeJSON(std::ostream& o, const SyntheticParams& P, const vector<BenchResult>& vR) {
+    o << "{\"version\": " << json_str(CodeVersion::repo_version) << ", \"tag\": " << json_str(CodeVersion::repo_tagname)
+      << ",\n \"params\": {\"nEvents\": " << P.nEvents << ", \"rate\": " << P.rate << ", \"jitter\": " << P.jitter
+      << ", \"multiplicity\": " << P.multiplicity << ", \"payload\": " << P.payload
+      << ", \"threads\": " << std::thread::hardware_concurrency() << "},\n \"results\": [";
+    bool first = true;
+    for(auto& R: vR) {
+        o << (first? "\n  " : ",\n  ") << "{\"topology\": " << json_str(R.topology)
+          << ", \"events\": " << R.nEvents << ", \"out\": " << R.nOut << ", \"seconds\": " << R.seconds
+          << ", \"events_per_s\": " << R.nEvents / R.seconds << ", \"ns_per_event\": " << 1e9 * R.seconds / R.nEvents
+          << ", \"peak_rss_kB\": " << R.peak_rss_kB << ", \"allocs\": " << R.allocs << ", \"alloc_bytes\": " << R.alloc_bytes
+          << ", \"stages\": [";
+        bool f2 = true;
+        for(auto& s: R.stages) {
+            o << (f2? "" : ", ") << "{\"stage\": " << json_str(s.name) << ", \"n_items\": " << s.n_items
+              << ", \"ns_per_item\": " << (s.n_items? 1e9 * s.t_push / s.n_items : 0.)
+              << ", \"queue_hwm\": " << s.queue_hwm << ", \"n_disordered\": " << s.n_disordered << "}";
+            f2 = false;
+        }
+        o << "]}";
+        first = false;
+    }
+    o << "\n]}\n";
+}
+
+/// run selected topologies for payload size N
+template<size_t N>
+vector<BenchResult> runAll(const SyntheticParams& P, const set<string>& topo, int nInputs) {
+    typedef OrderedData<BenchPayload<N>> E;
+
+    printf("Generating %zu events (%zu-byte payload)...\n", P.nEvents, sizeof(BenchPayload<N>));
+    auto v = generateEvents<E>(P);
+
+    vector<BenchResult> vR;
+    bool all = topo.count("all");
+    if(all || topo.count("ordering")) vR.push_back(benchOrdering(P, v));
+    if(all || topo.count("cluster")) vR.push_back(benchCluster(P, v));
+    if(all || topo.count("window")) vR.push_back(benchWindow(P, v));
+    if(all || topo.count("collator")) vR.push_back(benchCollator(P, v, nInputs));
+    if(all || topo.count("parallel")) vR.push_back(benchParallel(P, v));
+    return vR;
+}
+
+int main(int argc, char** argv) {
+    CodeVersion::display_code_version();
+    loadGlobalArgs(argc - 1, argv + 1);
+    _ProfilingSink::reportOnEnd() = false;
+
+    SyntheticParams P;
+    int n = P.nEvents;
+    optionalGlobalArg("nEvents", n, "number of synthetic events");
+    P.nEvents = std::max(n, 1);
+    optionalGlobalArg("rate", P.rate, "mean event rate [1/s]");
+    optionalGlobalArg("jitter", P.jitter, "maximum event arrival disorder [s]");
+    optionalGlobalArg("multiplicity", P.multiplicity, "mean events per time-correlated cluster");
+    optionalGlobalArg("payload", P.payload, "event payload size [bytes], rounded up to 16, 64, 256 or 1024");
+    int nInputs = 4;
+    optionalGlobalArg("nInputs", nInputs, "producer threads for collator topology");
+    string topos = "all";
+    optionalGlobalArg("topology", topos, "comma-separated topologies: ordering, cluster, window, collator, parallel, or all");
+    string fjson = "";
+    optionalGlobalArg("json", fjson, "JSON results output file");
+
+    set<string> topo;
+    std::stringstream ss(topos);
+    string t;
+    while(std::getline(ss, t, ',')) topo.insert(t);
+
+    vector<BenchResult> vR;
+    try {
+        if(P.payload <= 16) { P.payload = 16; vR = runAll<16>(P, topo, nInputs); }
+        else if(P.payload <= 64) { P.payload = 64; vR = runAll<64>(P, topo, nInputs); }
+        else if(P.payload <= 256) { P.payload = 256; vR = runAll<256>(P, topo, nInputs); }
+        else { P.payload = 1024; vR = runAll<1024>(P, topo, nInputs); }
+    } catch(std::exception& e) {
+        printf(TERMFG_RED TERMSGR_BOLD "Benchmark failed:\n\t%s" TERMSGR_RESET "\n", e.what());
+        return EXIT_FAILURE;
+    }
+
+    printf("\n");
+    for(auto& R: vR) printResult(R);
+    if(fjson.size()) {
+        std::ofstream f(fjson);
+        writeJSON(f, P, vR);
+        printf("\nResults written to '%s'\n", fjson.c_str());
+    }
+    return EXIT_SUCCESS;
+}
@@ -7,6 +7,8 @@
 #include <vector>
 #include <mutex>
 #include <cassert>
+#include <algorithm>
+#include <iterator>
 using std::vector;
 
 
@@ -64,4 +66,76 @@ protected:
     std::mutex poolLock;    ///< lock on pool
 };
 
+/// Thread-aware pool of re-usable objects exchanged by move, e.g. containers keeping their allocated capacity.
+/// Each thread keeps a local cache, refilled from or spilled to a shared locked pool in blocks.
+template<class T>
+class RecyclePool {
+public:
+    /// move a pooled (cleared) object into o, if available; return whether successful
+    static bool get(T& o) {
+        auto& L = local();
+        if(!L.items.size()) {
+            auto& S = shared();
+            std::lock_guard<std::mutex> lk(S.lock);
+            auto n = std::min(S.items.size(), blockSize);
+            std::move(S.items.end() - n, S.items.end(), std::back_inserter(L.items));
+            S.items.erase(S.items.end() - n, S.items.end());
+        }
+        if(!L.items.size()) { ++L.n_miss; return false; }
+        o = std::move(L.items.back());
+        L.items.pop_back();
+        ++L.n_reuse;
+        return true;
+    }
+
+    /// clear object and move it into pool
+    static void put(T& o) {
+        o.clear();
+        auto& L = local();
+        if(L.items.size() >= maxLocal) {
+            auto& S = shared();
+            std::lock_guard<std::mutex> lk(S.lock);
+            auto n = std::min(blockSize, maxShared - std::min(maxShared, S.items.size()));
+            std::move(L.items.end() - n, L.items.end(), std::back_inserter(S.items));
+            L.items.erase(L.items.end() - (n? n : 1), L.items.end()); // discard one if shared pool full
+        }
+        L.items.push_back(std::move(o));
+    }
+
+    /// number of successful get() calls in this thread
+    static size_t n_reused() { return local().n_reuse; }
+    /// number of get() calls in this thread finding empty pool
+    static size_t n_missed() { return local().n_miss; }
+
+    static constexpr size_t maxLocal = 256;     ///< maximum objects in per-thread cache
+    static constexpr size_t blockSize = 64;     ///< objects moved at once between local and shared pool
+    static constexpr size_t maxShared = 4096;   ///< maximum objects in shared pool
+
+protected:
+    /// per-thread cache
+    struct local_t {
+        vector<T> items;        ///< pooled objects
+        size_t n_reuse = 0;     ///< number of objects re-used
+        size_t n_miss = 0;      ///< number of requests finding empty pool
+    };
+    /// shared pool
+    struct shared_t {
+        vector<T> items;        ///< pooled objects
+        std::mutex lock;        ///< lock on items
+    };
+
+    /// this thread's cache
+    static local_t& local() { static thread_local local_t L; return L; }
+    /// shared pool
+    static shared_t& shared() { static shared_t S; return S; }
+};
+
+// out-of-class definitions for odr-use (std::min) in C++14
+template<class T>
+constexpr size_t RecyclePool<T>::maxLocal;
+template<class T>
+constexpr size_t RecyclePool<T>::blockSize;
+template<class T>
+constexpr size_t RecyclePool<T>::maxShared;
+
 #endif
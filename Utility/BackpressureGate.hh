@@ -0,0 +1,58 @@
+/// @file BackpressureGate.hh Named gate for throttling data sources on downstream queue watermarks
+
+#ifndef BACKPRESSUREGATE_HH
+#define BACKPRESSUREGATE_HH
+
+#include <condition_variable>
+#include <mutex>
+#include <map>
+#include <string>
+#include <functional>
+using std::string;
+
+/// Gate closed while any attached queue is above its high watermark.
+/// Queues report crossings through listener(); sources call wait_open() before producing more data.
+class BackpressureGate {
+public:
+    /// get (or create) gate by name, shared between configured queues and sources
+    static BackpressureGate& named(const string& name) {
+        static std::mutex m;
+        static std::map<string, BackpressureGate> gates;
+        std::lock_guard<std::mutex> lk(m);
+        return gates[name];
+    }
+
+    /// report one queue crossing high (true) or low (false) watermark
+    void set(bool high) {
+        std::lock_guard<std::mutex> lk(gateMut);
+        if(high) ++n_high;
+        else if(n_high) --n_high;
+        if(!n_high) opened.notify_all();
+    }
+
+    /// watermark callback for a queue
+    std::function<void(bool)> listener() { return [this](bool high) { set(high); }; }
+
+    /// block until no attached queues are above their high watermark
+    void wait_open() {
+        std::unique_lock<std::mutex> lk(gateMut);
+        if(!n_high) return;
+        ++n_waits;
+        opened.wait(lk, [this] { return !n_high; });
+    }
+
+    /// whether gate is currently open
+    bool is_open() {
+        std::lock_guard<std::mutex> lk(gateMut);
+        return !n_high;
+    }
+
+    size_t n_waits = 0;     ///< number of times a source was held at the gate
+
+protected:
+    std::mutex gateMut;                 ///< lock on state
+    std::condition_variable opened;     ///< notification of gate opening
+    size_t n_high = 0;                  ///< number of queues above high watermark
+};
+
+#endif
@@ -0,0 +1,81 @@
+/// @file CPUPlacement.cc
+
+#include "CPUPlacement.hh"
+#include <sched.h>
+#include <unistd.h>
+#include <fstream>
+#include <sstream>
+#include <map>
+#include <algorithm>
+
+/// read first line of (sysfs) file; empty if unavailable
+static string readLine(const string& f) {
+    std::ifstream i(f);
+    string s;
+    std::getline(i, s);
+    return s;
+}
+
+vector<int> parseCPUList(const string& s) {
+    vector<int> v;
+    std::stringstream ss(s);
+    string r;
+    while(std::getline(ss, r, ',')) {
+        if(r.find_first_of("0123456789") == string::npos) continue;
+        auto d = r.find('-');
+        int a = std::stoi(r.substr(0, d));
+        int b = d == string::npos? a : std::stoi(r.substr(d + 1));
+        for(int c = a; c <= b; ++c) v.push_back(c);
+    }
+    return v;
+}
+
+vector<int> numaNodeCPUs(int node) {
+    return parseCPUList(readLine("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist"));
+}
+
+vector<int> allowedCPUs() {
+    vector<int> v;
+    cpu_set_t s;
+    CPU_ZERO(&s);
+    if(!sched_getaffinity(0, sizeof(s), &s)) {
+        for(int c = 0; c < CPU_SETSIZE; ++c) if(CPU_ISSET(c, &s)) v.push_back(c);
+    }
+    return v;
+}
+
+vector<vector<int>> physicalCores(placement_t p) {
+    // group allowed CPUs by (socket, core)
+    std::map<int, std::map<int, vector<int>>> sockets;
+    for(auto c: allowedCPUs()) {
+        string t = "/sys/devices/system/cpu/cpu" + std::to_string(c) + "/topology/";
+        auto sp = readLine(t + "physical_package_id");
+        auto sc = readLine(t + "core_id");
+        int pkg = sp.size()? std::stoi(sp) : 0;
+        int core = sc.size()? std::stoi(sc) : c;
+        sockets[pkg][core].push_back(c);
+    }
+
+    vector<vector<vector<int>>> bysocket;
+    for(auto& kv: sockets) {
+        bysocket.emplace_back();
+        for(auto& kc: kv.second) bysocket.back().push_back(kc.second);
+    }
+
+    vector<vector<int>> v;
+    if(p == PLACE_COMPACT) {
+        for(auto& s: bysocket) v.insert(v.end(), s.begin(), s.end());
+    } else {
+        size_t n = 0;
+        for(auto& s: bysocket) n = std::max(n, s.size());
+        for(size_t i = 0; i < n; ++i)
+            for(auto& s: bysocket) if(i < s.size()) v.push_back(s[i]);
+    }
+    return v;
+}
+
+void firstTouch(void* p, size_t n) {
+    static const size_t pg = sysconf(_SC_PAGESIZE);
+    auto c = static_cast<volatile char*>(p);
+    for(size_t i = 0; i < n; i += pg) c[i] = 0;
+}
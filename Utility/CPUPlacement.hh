@@ -0,0 +1,32 @@
+/// @file CPUPlacement.hh CPU topology queries and thread placement helpers (Linux sysfs)
+
+#ifndef CPUPLACEMENT_HH
+#define CPUPLACEMENT_HH
+
+#include <string>
+using std::string;
+#include <vector>
+using std::vector;
+#include <cstddef>
+
+/// parse Linux cpulist format (e.g. "0-3,8,10-11") to CPU numbers
+vector<int> parseCPUList(const string& s);
+/// CPUs on NUMA node (empty if unknown)
+vector<int> numaNodeCPUs(int node);
+/// CPUs available to this process
+vector<int> allowedCPUs();
+
+/// CPU placement policy for groups of worker threads
+enum placement_t {
+    PLACE_NONE      = 0,    ///< no affinity; scheduler decides
+    PLACE_SPREAD    = 1,    ///< one physical core per worker, alternating between sockets
+    PLACE_COMPACT   = 2     ///< one physical core per worker, filling each socket in turn
+};
+
+/// allowed physical cores (each a list of hyperthread sibling CPUs), in placement policy order
+vector<vector<int>> physicalCores(placement_t p = PLACE_SPREAD);
+
+/// touch each memory page of [p, p + n) from calling thread, for NUMA first-touch placement
+void firstTouch(void* p, size_t n);
+
+#endif
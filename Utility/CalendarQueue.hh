@@ -0,0 +1,194 @@
+/// @file CalendarQueue.hh Bucketed "calendar queue" priority queue for nearly-ordered keys
+
+#ifndef CALENDARQUEUE_HH
+#define CALENDARQUEUE_HH
+
+#include "deref_if_ptr.hh"
+#include <vector>
+using std::vector;
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <stdint.h>
+
+/// Calendar queue (R. Brown, CACM 31(10), 1988): amortized O(1) insert/remove for keys arriving nearly in order
+/// Drop-in for std::priority_queue (push/top/pop/size/empty), always returning lowest ordering_t(deref_if_ptr(v)) first.
+/// Items are hashed into a power-of-two ring of unsorted buckets of width w;
+/// the bucket being drained is moved into a small sorted "front" buffer.
+template<typename V, typename ordering_t>
+class CalendarQueue {
+public:
+    /// stored value type
+    typedef V value_type;
+
+    /// Constructor, with initial bucket width guess
+    explicit CalendarQueue(double w0 = 1) { setWidth(w0); buckets.resize(nbuckets); }
+
+    /// number of items held
+    size_t size() const { return n; }
+    /// check if empty
+    bool empty() const { return !n; }
+
+    /// add item
+    void push(const V& v) {
+        auto vb = vbucket(v);
+        if(front.size() && vb == cur_vb) {
+            auto it = std::upper_bound(front.begin(), front.end(), v, [](const V& a, const V& b) { return key(b) < key(a); });
+            front.insert(it, v);
+        } else {
+            if(vb < cur_vb) {   // earlier than current position: rewind
+                unloadFront();
+                cur_vb = vb;
+            }
+            buckets[vb & mask].push_back(v);
+        }
+        if(++n > 2 * nbuckets) rehash(2 * nbuckets);
+    }
+
+    /// lowest-ordered item; only call when non-empty
+    const V& top() {
+        if(front.empty()) advance();
+        return front.back();
+    }
+
+    /// remove lowest-ordered item
+    void pop() {
+        if(front.empty()) advance();
+        front.pop_back();
+        if(--n < nbuckets / 4 && nbuckets > min_buckets) rehash(nbuckets / 2);
+    }
+
+    /// set expected span of held keys, used to choose bucket width while queue is small
+    void setWindow(double w) {
+        if(w == window) return;
+        window = w;
+        if(n < min_buckets) rehash(nbuckets);
+    }
+
+    /// current bucket width
+    double getWidth() const { return width; }
+    /// current number of buckets
+    size_t getNBuckets() const { return nbuckets; }
+    /// number of times re-bucketed
+    size_t nRehash = 0;
+
+protected:
+    static constexpr size_t min_buckets = 16;   ///< minimum number of buckets
+
+    /// item ordering key
+    static ordering_t key(const V& v) { return ordering_t(deref_if_ptr(v)); }
+    /// "virtual" (un-wrapped) bucket number for item
+    int64_t vbucket(const V& v) const { return vbucket_k(key(v), std::is_integral<ordering_t>()); }
+    /// bucket number for integral key, in exact integer arithmetic
+    int64_t vbucket_k(ordering_t k, std::true_type) const { return vbucket_i(k, std::is_unsigned<ordering_t>()); }
+    /// bucket number for signed integral key
+    int64_t vbucket_i(ordering_t k, std::false_type) const {
+        auto i = int64_t(k);
+        auto q = i / iwidth;
+        return i % iwidth < 0? q - 1 : q;
+    }
+    /// bucket number for unsigned integral key, in unsigned arithmetic, clamped to 2^62 as for floating-point keys
+    int64_t vbucket_i(ordering_t k, std::true_type) const {
+        return int64_t(std::min(uint64_t(k) / uint64_t(iwidth), uint64_t(1) << 62));
+    }
+    /// bucket number for floating-point key, clamped to +-2^62 (extreme keys share end buckets, with headroom for bucket scanning)
+    int64_t vbucket_k(ordering_t k, std::false_type) const {
+        const double q = std::floor(double(k) / width);
+        if(std::isnan(q)) throw std::domain_error("CalendarQueue given NaN ordering key");
+        constexpr double qmax = double(int64_t(1) << 62);
+        return int64_t(std::max(-qmax, std::min(q, qmax)));
+    }
+    /// set bucket width (at least 1, and in int64_t range, for integral keys)
+    void setWidth(double w) {
+        iwidth = int64_t(std::max(1., std::min(std::ceil(w), double(int64_t(1) << 62))));
+        width = std::is_integral<ordering_t>::value? double(iwidth) : w;
+    }
+
+    /// return front buffer contents to buckets
+    void unloadFront() {
+        if(front.empty()) return;
+        auto& b = buckets[cur_vb & mask];
+        b.insert(b.end(), front.begin(), front.end());
+        front.clear();
+    }
+
+    /// locate next bucket with contents and move its current-year items into sorted front buffer
+    void advance() {
+        if(!n) throw std::logic_error("CalendarQueue accessed when empty");
+        size_t nscan = 0;
+        while(front.empty()) {
+            // sparse queue, or a full "year" with nothing: jump directly to lowest item
+            if((!nscan && n < min_buckets) || nscan == nbuckets) {
+                const V* vmin = nullptr;
+                for(auto& b: buckets) for(auto& v: b) if(!vmin || key(v) < key(*vmin)) vmin = &v;
+                cur_vb = vbucket(*vmin);
+            }
+
+            auto& b = buckets[cur_vb & mask];
+            auto it = std::partition(b.begin(), b.end(), [this](const V& v) { return vbucket(v) != cur_vb; });
+            if(it == b.end()) { ++cur_vb; ++nscan; continue; }
+
+            front.assign(it, b.end());
+            b.erase(it, b.end());
+
+            // overfull bucket indicates mis-estimated width; re-bucket (at most once per n operations)
+            if(front.size() > 64 && front.size() > 8 * (n / nbuckets + 1) && nsince_rehash > n) {
+                rehash(nbuckets);
+                nscan = 0;
+                continue;
+            }
+            std::sort(front.begin(), front.end(), [](const V& x, const V& y) { return key(y) < key(x); });
+        }
+        ++nsince_rehash;
+    }
+
+    /// re-distribute contents into nb buckets, re-estimating bucket width from observed item spacing
+    void rehash(size_t nb) {
+        unloadFront();
+        vector<V> v;
+        v.reserve(n);
+        for(auto& b: buckets) {
+            v.insert(v.end(), b.begin(), b.end());
+            b.clear();
+        }
+
+        if(v.size() >= min_buckets) {
+            auto k0 = key(v[0]), k1 = k0;
+            for(auto& x: v) {
+                auto k = key(x);
+                if(k < k0) k0 = k;
+                if(k1 < k) k1 = k;
+            }
+            // ~ 1/3 items per bucket, per Brown's heuristic
+            auto w = 3 * (double(k1) - double(k0)) / (v.size() - 1);
+            if(w > 0 && std::isfinite(w)) setWidth(w);   // infinite keys: keep current width
+        } else if(window > 0 && std::isfinite(window) && window < std::numeric_limits<double>::max()) setWidth(window / nb);
+
+        nbuckets = nb;
+        mask = nb - 1;
+        buckets.resize(nbuckets);
+        cur_vb = std::numeric_limits<int64_t>::max();
+        for(auto& x: v) {
+            auto vb = vbucket(x);
+            cur_vb = std::min(cur_vb, vb);
+            buckets[vb & mask].push_back(x);
+        }
+        nsince_rehash = 0;
+        ++nRehash;
+    }
+
+    vector<vector<V>> buckets;  ///< unsorted item buckets
+    vector<V> front;            ///< current bucket contents, sorted descending
+    size_t nbuckets = min_buckets;  ///< number of buckets (power of 2)
+    size_t mask = min_buckets - 1;  ///< nbuckets - 1, for wrapping bucket index
+    double width;               ///< bucket width
+    int64_t iwidth;             ///< integer bucket width, for integral keys
+    int64_t cur_vb = std::numeric_limits<int64_t>::max();  ///< current (lowest possible) virtual bucket number
+    size_t n = 0;               ///< number of items held
+    size_t nsince_rehash = 0;   ///< bucket advances since last rehash
+    double window = 0;          ///< expected span of held keys
+};
+
+#endif
@@ -0,0 +1,124 @@
+/// @file ChaseLevDeque.hh Lock-free work-stealing deque (Chase-Lev, with C11 memory model ordering)
+
+#ifndef CHASELEVDEQUE_HH
+#define CHASELEVDEQUE_HH
+
+#include <atomic>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <type_traits>
+
+/// Lock-free growable work-stealing deque
+/// One "owner" thread pushes and pops at the bottom (LIFO); any thread may steal from the top (FIFO).
+/// Elements must be trivially copyable (typically pointers). Replaced storage arrays are retained
+/// until destruction, since a concurrent thief may still be reading from them.
+template<typename T>
+class ChaseLevDeque {
+public:
+    static_assert(std::is_trivially_copyable<T>::value, "ChaseLevDeque requires trivially copyable elements");
+
+    /// Constructor, with initial capacity rounded up to power of 2
+    explicit ChaseLevDeque(size_t n = 256) {
+        size_t c = 2;
+        while(c < n) c <<= 1;
+        arrays.push_back(new array_t(c));
+        A.store(arrays.back(), std::memory_order_relaxed);
+    }
+    /// Destructor
+    ~ChaseLevDeque() { for(auto a: arrays) delete a; }
+    /// no copying
+    ChaseLevDeque(const ChaseLevDeque&) = delete;
+    /// no assignment
+    ChaseLevDeque& operator=(const ChaseLevDeque&) = delete;
+
+    /// (owner only) add item at bottom
+    void push(T x) {
+        auto b = bottom.load(std::memory_order_relaxed);
+        auto t = top.load(std::memory_order_acquire);
+        auto a = A.load(std::memory_order_relaxed);
+        if(b - t > int64_t(a->mask)) a = grow(a, t, b);
+        a->put(b, x);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom.store(b + 1, std::memory_order_relaxed);
+    }
+
+    /// (owner only) remove most recently pushed item; return false if empty
+    bool pop(T& x) {
+        auto b = bottom.load(std::memory_order_relaxed) - 1;
+        auto a = A.load(std::memory_order_relaxed);
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto t = top.load(std::memory_order_relaxed);
+
+        if(t > b) { // empty
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return false;
+        }
+        x = a->get(b);
+        if(t == b) { // last item: race against thieves
+            bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+
+    /// (any thread) remove oldest item; return false if empty or lost race to another thread
+    bool steal(T& x) {
+        auto t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto b = bottom.load(std::memory_order_acquire);
+        if(t >= b) return false;
+        auto a = A.load(std::memory_order_acquire);
+        x = a->get(t);
+        return top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+    }
+
+    /// approximate number of items (exact only when quiescent)
+    size_t size() const {
+        auto b = bottom.load(std::memory_order_relaxed);
+        auto t = top.load(std::memory_order_relaxed);
+        return b > t? b - t : 0;
+    }
+    /// approximate check for emptiness
+    bool empty() const { return !size(); }
+    /// current storage capacity
+    size_t capacity() const { return A.load(std::memory_order_relaxed)->mask + 1; }
+
+protected:
+    /// circular storage array
+    struct array_t {
+        /// Constructor, for power-of-2 capacity c
+        explicit array_t(size_t c): mask(c - 1), buf(new std::atomic<T>[c]) { }
+        /// Destructor
+        ~array_t() { delete[] buf; }
+        /// store element at logical position i
+        void put(int64_t i, T x) { buf[i & mask].store(x, std::memory_order_relaxed); }
+        /// load element at logical position i
+        T get(int64_t i) const { return buf[i & mask].load(std::memory_order_relaxed); }
+
+        const size_t mask;      ///< capacity - 1
+        std::atomic<T>* buf;    ///< element storage
+    };
+
+    /// (owner only) replace storage with double-size copy
+    array_t* grow(array_t* a, int64_t t, int64_t b) {
+        auto a2 = new array_t(2 * (a->mask + 1));
+        for(auto i = t; i < b; ++i) a2->put(i, a->get(i));
+        arrays.push_back(a2);
+        A.store(a2, std::memory_order_release);
+        return a2;
+    }
+
+    // explicit padding (not alignas, which plain new ignores before C++17) keeps top and bottom on separate cache lines
+    static constexpr size_t cacheline = 64;     ///< assumed cache line size [bytes]
+    char pad_top[cacheline];                    ///< separation from preceding data
+    std::atomic<int64_t> top{0};                ///< steal position
+    char pad_bottom[cacheline - sizeof(std::atomic<int64_t>)];  ///< separation of top and bottom
+    std::atomic<int64_t> bottom{0};             ///< owner push/pop position
+    std::atomic<array_t*> A{nullptr};           ///< current storage
+    std::vector<array_t*> arrays;               ///< all allocated storage (owner only)
+};
+
+#endif
@@ -0,0 +1,87 @@
+/// @file LoserTree.hh Tournament ("loser") tree for k-way merging
+
+#ifndef LOSERTREE_HH
+#define LOSERTREE_HH
+
+#include <vector>
+using std::vector;
+#include <cstddef>
+#include <utility>
+
+/// Tournament ("loser") tree selecting lowest key among k inputs
+/// Each internal node holds the loser of the match below it, so updating the winner's key
+/// replays only its leaf-to-root path: log2(k) comparisons, with no per-update allocation.
+/// Inputs may be marked "exhausted" (sorting after all keys).
+template<typename K>
+class LoserTree {
+public:
+    /// Constructor, for k inputs (all initially exhausted)
+    explicit LoserTree(size_t _k = 0) { resize(_k); }
+
+    /// reset number of inputs (all exhausted)
+    void resize(size_t _k) {
+        k = _k;
+        key.assign(k, K{});
+        done.assign(k, true);
+        L.assign(k? k : 1, 0);
+    }
+
+    /// number of inputs
+    size_t size() const { return k; }
+
+    /// set input key, without updating tree (call build() after setting all)
+    void set(size_t i, const K& x) { key[i] = x; done[i] = false; }
+    /// mark input exhausted, without updating tree
+    void set_done(size_t i) { done[i] = true; }
+
+    /// (re)build tree from current keys: O(k)
+    void build() {
+        if(!k) return;
+        vector<size_t> W(2*k);
+        for(size_t i = 0; i < k; ++i) W[k+i] = i;
+        for(size_t n = k-1; n > 0; --n) {
+            auto a = W[2*n], b = W[2*n+1];
+            if(less(b, a)) std::swap(a, b);
+            W[n] = a;
+            L[n] = b;
+        }
+        L[0] = k > 1? W[1] : 0;
+    }
+
+    /// index of input with lowest key
+    size_t winner() const { return L[0]; }
+    /// whether input is exhausted
+    bool is_done(size_t i) const { return done[i]; }
+    /// whether all inputs exhausted
+    bool empty() const { return !k || done[L[0]]; }
+    /// current key for input
+    const K& getKey(size_t i) const { return key[i]; }
+
+    /// update key for current winner i and replay its path: O(log k)
+    void update(size_t i, const K& x) { set(i, x); replay(i); }
+    /// mark current winner i exhausted and replay its path
+    void update_done(size_t i) { set_done(i); replay(i); }
+
+    /// replay matches from input i to root after change in its key; only valid for i = winner() (otherwise, build())
+    void replay(size_t i) {
+        size_t w = i;
+        for(size_t n = (k+i)/2; n > 0; n /= 2)
+            if(less(L[n], w)) std::swap(L[n], w);
+        L[0] = w;
+    }
+
+protected:
+    /// comparison including exhausted state; ties broken by input number for stability
+    bool less(size_t a, size_t b) const {
+        if(done[a]) return false;
+        if(done[b]) return true;
+        return key[a] < key[b] || (!(key[b] < key[a]) && a < b);
+    }
+
+    size_t k = 0;           ///< number of inputs
+    vector<K> key;          ///< current key for each input
+    vector<bool> done;      ///< exhausted flag for each input
+    vector<size_t> L;       ///< match losers at internal nodes; winner at [0]
+};
+
+#endif
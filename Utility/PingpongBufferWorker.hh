@@ -6,7 +6,11 @@
 
 #include "Threadworker.hh"
 #include "TermColor.hh"
+#include "CPUPlacement.hh"
 #include <unistd.h>
+#include <chrono>
+#include <functional>
+#include <iterator>
 
 /// Buffered input to sink running in independent thread
 template<typename T>
@@ -14,6 +18,13 @@ class PingpongBufferWorker: public Threadworker {
 public:
     typedef typename std::remove_const<T>::type Tmut_t;
 
+    /// policy when input buffer is at capacity
+    enum overflow_t {
+        OVERFLOW_BLOCK          = 0,    ///< block producer until buffer is swapped out
+        OVERFLOW_DROP_OLDEST    = 1,    ///< discard oldest queued items
+        OVERFLOW_DROP_NEWEST    = 2     ///< discard incoming items
+    };
+
     /// receive item to input buffer
     void add_item(T& o) {
         if(!checkRunning()) {
@@ -23,12 +34,39 @@ public:
             return;
         }
 
-        lock_guard<mutex> l(inputMut);
-        datq.push_back(o);
+        unique_lock<mutex> l(inputMut);
+        if(make_room(l, 1)) datq.push_back(o);
+        check_watermark();
         inputReady.notify_one();
+        l.unlock();
         sched_yield();
     }
 
+    /// receive range of items to input buffer, under one lock
+    template<typename It>
+    void add_items(It i0, It i1) {
+        if(!checkRunning()) {
+            _datq.insert(_datq.end(), i0, i1);
+            processout();
+            _datq.clear();
+            return;
+        }
+
+        unique_lock<mutex> l(inputMut);
+        size_t n = std::distance(i0, i1);
+        size_t nk = make_room(l, n);
+        if(nk < n) {
+            if(overflow == OVERFLOW_DROP_OLDEST) std::advance(i0, n - nk);
+            else { i1 = i0; std::advance(i1, nk); }
+        }
+        if(nk) {
+            datq_batches.push_back(datq.size());
+            datq.insert(datq.end(), i0, i1);
+        }
+        check_watermark();
+        inputReady.notify_one();
+    }
+
     /// thread to pull from queue and push downstream
     void threadjob() override {
         while(true) {
@@ -36,13 +74,16 @@ public:
 
             { // get input items ready to pass on
                 unique_lock<mutex> lk(inputMut);    // acquire unique_lock on queue in this scope
+                n_out = 0;  // previous output buffer done
+                check_watermark();
                 if(runstat == STOP_REQUESTED) {
                     if(verbose > 3) printf(TERMFG_YELLOW "  PingpongBufferWorker [%i] got stop command." TERMSGR_RESET "\n", worker_id);
                     break;
                 }
-                if(!datq.size()) {
+                if(!datq.size() && !idle_work()) {
                     if(verbose > 4) printf(TERMFG_BLUE "  PingpongBufferWorker [%i] awaiting new input." TERMSGR_RESET "\n", worker_id);
-                    inputReady.wait(lk); // unlock; wait; re-lock when notified
+                    if(idle_poll_us > 0) inputReady.wait_for(lk, std::chrono::microseconds(idle_poll_us));
+                    else inputReady.wait(lk); // unlock; wait; re-lock when notified
                 }
                 pingpong();
             }
@@ -51,8 +92,11 @@ public:
             _datq.clear();
         }
 
+        spaceReady.notify_all();
         if(verbose > 3)
-            printf(TERMFG_BLUE "  PingpongBufferWorker [%i] done (max buffered: %zu)." TERMSGR_RESET "\n", worker_id, most_buffered);
+            printf(TERMFG_BLUE "  PingpongBufferWorker [%i] done (max buffered: %zu; %zu full waits, %zu dropped)." TERMSGR_RESET "\n",
+                   worker_id, most_buffered, n_full_waits, n_dropped);
+        peak_buffered = std::max(peak_buffered, most_buffered);
         most_buffered = 0;
     }
 
@@ -62,6 +106,9 @@ public:
         pingpong();
         processout();
         _datq.clear();
+        lock_guard<mutex> l(inputMut);
+        n_out = 0;
+        check_watermark();
     }
 
     /// backlog of items not yet passed to thread queue
@@ -70,16 +117,107 @@ public:
         return datq.size();
     }
 
+    /// most items buffered at once, over all runs
+    size_t max_buffered() const { return std::max(peak_buffered, most_buffered); }
+
+    int idle_poll_us = 0;       ///< interval to re-try idle_work() while waiting for input (0 to only wait for input)
+
+    size_t capacity = 0;        ///< maximum items in input buffer (0 for unlimited)
+    size_t prealloc = 0;        ///< items to pre-allocate in buffers at placed thread launch (default capacity, or prealloc_unbounded)
+    static constexpr size_t prealloc_unbounded = 4096;  ///< default pre-allocation for placed buffers without capacity
+    overflow_t overflow = OVERFLOW_BLOCK;   ///< policy when input buffer is at capacity
+    size_t high_water = 0;      ///< queued items (input + in-process output) triggering watermark_cb(true); 0 to disable
+    size_t low_water = 0;       ///< queued items at or below which watermark_cb(false) follows a high crossing
+    /// watermark crossing notification, called with input lock held (must not call back into this buffer)
+    std::function<void(bool)> watermark_cb;
+
+    size_t n_dropped = 0;       ///< number of items discarded by overflow policy
+    size_t n_full_waits = 0;    ///< number of times producer blocked on full buffer
+
 protected:
     vector<Tmut_t> datq;        ///< input FIFO
     vector<Tmut_t> _datq;       ///< ping-pong for datq
+    vector<size_t> datq_batches;///< start positions of add_items() batches in datq
     size_t most_buffered = 0;   ///< record most items buffered
+    size_t peak_buffered = 0;   ///< most_buffered over previous thread runs
+    size_t n_out = 0;           ///< items in output buffer being processed (for watermarks)
+    bool above_high = false;    ///< whether high watermark crossing has been signalled
+    std::condition_variable spaceReady; ///< input buffer space freed notifier
+
+    /// apply overflow policy (holding inputMut) for adding n items; return number of (newest, for DROP_OLDEST) items to keep
+    size_t make_room(unique_lock<mutex>& lk, size_t n) {
+        if(!capacity || datq.size() + n <= capacity) return n;
+
+        if(overflow == OVERFLOW_BLOCK) {
+            ++n_full_waits;
+            inputReady.notify_one();
+            spaceReady.wait(lk, [&] {
+                return datq.size() + n <= capacity || !datq.size() || runstat == STOP_REQUESTED || runstat == IDLE;
+            });
+            return n;
+        }
+
+        size_t nk = capacity > datq.size()? std::min(n, capacity - datq.size()) : 0;
+        if(overflow == OVERFLOW_DROP_OLDEST) {
+            nk = std::min(n, capacity);
+            // drop at least 1/16 of capacity at once, amortizing buffer shift
+            size_t ndrop = std::min(datq.size(), std::max(datq.size() + nk - capacity, capacity / 16));
+            drop_oldest(ndrop);
+            count_dropped(ndrop);
+        }
+        count_dropped(n - nk);
+        return nk;
+    }
+
+    /// discard n oldest items from input buffer (holding inputMut)
+    virtual void drop_oldest(size_t n) {
+        if(!n) return;
+        datq.erase(datq.begin(), datq.begin() + n);
+        size_t j = 0;
+        for(auto b: datq_batches) {
+            b = b > n? b - n : 0;
+            if(!j || datq_batches[j - 1] != b) datq_batches[j++] = b;
+        }
+        datq_batches.resize(j);
+    }
+
+    /// record n discarded items
+    virtual void count_dropped(size_t n) { n_dropped += n; }
+
+    /// allocate buffers from worker thread, placing pages in worker's NUMA node (if placed) on first touch
+    void thread_init() override {
+        if(!hasPlacement()) return;
+        size_t n = prealloc? prealloc : capacity? capacity : prealloc_unbounded;
+        lock_guard<mutex> l(inputMut);
+        for(auto q: {&datq, &_datq}) {
+            if(q->capacity() >= n) continue;
+            vector<Tmut_t> v;
+            v.reserve(n);
+            firstTouch(v.data(), n * sizeof(Tmut_t));
+            v.insert(v.end(), q->begin(), q->end());
+            std::swap(*q, v);
+        }
+    }
+
+    /// check queue level against watermarks (holding inputMut), notifying on crossings
+    void check_watermark() {
+        if(!high_water || !watermark_cb) return;
+        auto n = datq.size() + n_out;
+        if(!above_high && n >= high_water) watermark_cb(above_high = true);
+        else if(above_high && n <= low_water) watermark_cb(above_high = false);
+    }
+
+    /// called in worker thread (holding inputMut) when input is empty; return whether datq was filled
+    virtual bool idle_work() { return false; }
 
     /// swap input/output buffers
     virtual void pingpong() {
         if(_datq.size()) throw std::logic_error("output buffer uncleared");
         std::swap(datq, _datq);
+        datq_batches.clear();
+        n_out = _datq.size();
         most_buffered = std::max(most_buffered, _datq.size());
+        if(capacity) spaceReady.notify_all();
     }
 
     /// process output buffer contents
@@ -89,4 +227,8 @@ protected:
     }
 };
 
+// out-of-class definition for odr-use in C++14
+template<typename T>
+constexpr size_t PingpongBufferWorker<T>::prealloc_unbounded;
+
 #endif
@@ -0,0 +1,216 @@
+/// @file SPSCRing.hh Lock-free bounded single-producer/single-consumer ring buffer
+
+#ifndef SPSCRING_HH
+#define SPSCRING_HH
+
+#include <atomic>
+#include <vector>
+#include <cstdint>
+#include <climits>
+#include <ctime>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+/// processor hint for spin-wait loops
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+/// Futex-backed event count: spin, then sleep until notified
+class FutexEvent {
+public:
+    /// wait until pred() is true: poll nspin times, then sleep (timeout_us > 0 to return after timeout)
+    template<class Pred>
+    bool await(Pred pred, int nspin = 256, long timeout_us = 0) {
+        for(int i = 0; i < nspin; ++i) {
+            if(pred()) return true;
+            cpu_relax();
+        }
+        struct timespec ts = { timeout_us / 1000000, (timeout_us % 1000000) * 1000 };
+        while(true) {
+            auto s = seq.load(std::memory_order_acquire);
+            nwait.fetch_add(1, std::memory_order_seq_cst);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if(pred()) { nwait.fetch_sub(1, std::memory_order_relaxed); return true; }
+            futex(FUTEX_WAIT_PRIVATE, s, timeout_us > 0? &ts : nullptr);
+            nwait.fetch_sub(1, std::memory_order_relaxed);
+            if(pred()) return true;
+            if(timeout_us > 0) return false;
+        }
+    }
+
+    /// wake all waiters; nearly free when nobody is sleeping
+    void notify() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if(!nwait.load(std::memory_order_relaxed)) return;
+        seq.fetch_add(1, std::memory_order_release);
+        futex(FUTEX_WAKE_PRIVATE, INT_MAX, nullptr);
+    }
+
+    /// wake one waiter (others remain asleep)
+    void notify_one() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if(!nwait.load(std::memory_order_relaxed)) return;
+        seq.fetch_add(1, std::memory_order_release);
+        futex(FUTEX_WAKE_PRIVATE, 1, nullptr);
+    }
+
+protected:
+    /// futex system call on seq
+    long futex(int op, uint32_t val, const struct timespec* ts) {
+        return syscall(SYS_futex, reinterpret_cast<uint32_t*>(&seq), op, val, ts, nullptr, 0);
+    }
+
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex requires plain 32-bit atomic");
+    std::atomic<uint32_t> seq{0};   ///< event sequence number (futex word)
+    std::atomic<int> nwait{0};      ///< number of sleeping (or about-to-sleep) waiters
+};
+
+/// Lock-free bounded single-producer/single-consumer ring buffer
+/// Exactly one thread may call the producer (push) functions, and one the consumer (front/pop) functions.
+template<typename T>
+class SPSCRing {
+public:
+    /// stored item type
+    typedef T value_type;
+
+    /// Constructor, with capacity rounded up to power of 2
+    explicit SPSCRing(size_t n = 1024) { allocate(n); }
+    /// Destructor
+    ~SPSCRing() { clear(); }
+    /// no copying
+    SPSCRing(const SPSCRing&) = delete;
+    /// no assignment
+    SPSCRing& operator=(const SPSCRing&) = delete;
+
+    /// change capacity (rounded up to power of 2), discarding contents; not thread safe!
+    void allocate(size_t n) {
+        clear();
+        size_t c = 2;
+        while(c < n) {
+            if(c > SIZE_MAX / 2) throw std::length_error("SPSCRing capacity too large");
+            c <<= 1;
+        }
+        buf = vector_t(c);
+        mask = c - 1;
+    }
+    /// discard all contents; not thread safe!
+    void clear() {
+        while(front()) pop();
+        head.store(0);
+        tail.store(0);
+        head_cache = tail_cache = 0;
+    }
+
+    /// maximum number of items held
+    size_t capacity() const { return mask + 1; }
+    /// number of items held (approximate while in use)
+    size_t size() const {
+        auto h = head.load(std::memory_order_acquire);  // before tail, so never past it
+        return tail.load(std::memory_order_acquire) - h;
+    }
+    /// check if empty (approximate while in use)
+    bool empty() const { return !size(); }
+
+    //-------------------
+    // producer interface
+
+    /// construct item at end of queue if space available; return whether successful
+    template<typename... Args>
+    bool try_emplace(Args&&... a) {
+        auto t = tail.load(std::memory_order_relaxed);
+        if(t - head_cache > mask) {
+            head_cache = head.load(std::memory_order_acquire);
+            if(t - head_cache > mask) return false;
+        }
+        new(&buf[t & mask]) T(std::forward<Args>(a)...);
+        tail.store(t + 1, std::memory_order_release);
+        dataReady.notify();
+        return true;
+    }
+    /// construct item at end of queue, blocking until space is available
+    template<typename... Args>
+    void emplace(Args&&... a) {
+        while(!try_emplace(std::forward<Args>(a)...)) {
+            ++n_full_waits;
+            spaceReady.await([this] { return size() <= mask; });
+        }
+    }
+    /// copy item onto queue, blocking until space is available
+    void push(const T& o) { emplace(o); }
+    /// copy item onto queue if space available
+    bool try_push(const T& o) { return try_emplace(o); }
+
+    /// mark end-of-input, waking consumer
+    void close() { closed.store(true, std::memory_order_release); dataReady.notify(); }
+    /// re-open after close()
+    void reopen() { closed.store(false, std::memory_order_release); }
+    /// check whether input is closed
+    bool is_closed() const { return closed.load(std::memory_order_acquire); }
+
+    //-------------------
+    // consumer interface
+
+    /// get pointer to oldest item, or nullptr if empty
+    T* front() {
+        auto h = head.load(std::memory_order_relaxed);
+        if(h == tail_cache) {
+            tail_cache = tail.load(std::memory_order_acquire);
+            if(h == tail_cache) return nullptr;
+        }
+        return reinterpret_cast<T*>(&buf[h & mask]);
+    }
+    /// remove (destruct) oldest item; only call after non-null front()
+    void pop() {
+        auto h = head.load(std::memory_order_relaxed);
+        reinterpret_cast<T*>(&buf[h & mask])->~T();
+        head.store(h + 1, std::memory_order_release);
+        spaceReady.notify();
+    }
+    /// wait for oldest item (or timeout_us > 0 elapsed); nullptr if closed and empty, or on timeout
+    T* wait_front(long timeout_us = 0) {
+        T* p = nullptr;
+        dataReady.await([&] { return (p = front()) || is_closed(); }, 256, timeout_us);
+        return p? p : front();
+    }
+    /// wake consumer from wait_front(), e.g. to respond to external state changes
+    void wake_consumer() { dataReady.notify(); }
+
+    size_t n_full_waits = 0;    ///< number of times producer blocked on full queue
+
+protected:
+    /// raw storage for one item
+    typedef typename std::aligned_storage<sizeof(T), alignof(T)>::type storage_t;
+    /// storage buffer type
+    typedef std::vector<storage_t> vector_t;
+
+    /// padding to keep producer and consumer data on separate cache lines
+    static constexpr size_t CACHELINE = 64;
+
+    vector_t buf;                   ///< item storage
+    size_t mask = 0;                ///< capacity - 1, for index wraparound
+    char _pad0[CACHELINE];          ///< cache line padding
+
+    std::atomic<size_t> head{0};    ///< consumer read position
+    size_t tail_cache = 0;          ///< consumer's cached copy of tail
+    char _pad1[CACHELINE - sizeof(std::atomic<size_t>) - sizeof(size_t)];   ///< cache line padding
+
+    std::atomic<size_t> tail{0};    ///< producer write position
+    size_t head_cache = 0;          ///< producer's cached copy of head
+    std::atomic<bool> closed{false};///< end-of-input marker
+    char _pad2[CACHELINE - sizeof(std::atomic<size_t>) - sizeof(size_t) - sizeof(std::atomic<bool>)];   ///< cache line padding
+
+    FutexEvent dataReady;           ///< consumer wait for data
+    char _pad3[CACHELINE];          ///< cache line padding
+    FutexEvent spaceReady;          ///< producer wait for space
+};
+
+#endif
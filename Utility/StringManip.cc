@@ -183,3 +183,13 @@ string commonpfx(const string& s1, const string& s2) {
     for(; i<smax; i++) if(s1[i] != s2[i]) break;
     return s1.substr(0,i);
 }
+
+string json_str(const string& s) {
+    string o = "\"";
+    for(auto c: s) {
+        if(c == '"' || c == '\\') o += '\\';
+        if((unsigned char)c < 0x20) o += ' ';
+        else o += c;
+    }
+    return o + "\"";
+}
@@ -86,6 +86,8 @@ string suffix(const string& str, const string& splitchars = ".");
 std::pair<string,string> splitLast(const string& str, const string& splitchars);
 /// keep starting characters in common between two strings
 string commonpfx(const string& s1, const string& s2);
+/// quoted JSON string literal (escaping quotes and backslashes; control characters replaced by spaces)
+string json_str(const string& s);
 
 /// display formatted time from timestamp
 string displayTime(double t);
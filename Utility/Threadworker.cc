@@ -2,14 +2,20 @@
 
 #include "Threadworker.hh"
 #include "TermColor.hh"
+#include "CPUPlacement.hh"
+#include "WorkerThreadPool.hh"
 #include <time.h>
 #include <cmath>
 #include <signal.h>
+#include <algorithm>
+#include <chrono>
 
 thread_local int _thread_id = -1;
 
 int Threadworker::thread_id() { return _thread_id; }
 
+bool Threadworker::pool_default = false;
+
 Threadworker::Threadworker(int i, ThreadManager* m):
 worker_id(i), myManager(m) { }
 
@@ -39,6 +45,7 @@ void Threadworker::run_here() {
     if(verbose > 1) printf(TERMFG_GREEN "Running Threadworker [%i] locally." TERMSGR_RESET "\n", worker_id);
     if(checkRunning()) throw std::logic_error("Double launch attempted");
     runstat = RUNLOCAL;
+    thread_init();
     threadjob();
     runstat = IDLE;
     if(verbose > 2) printf(TERMFG_RED "Threadworker [%i] completed locally." TERMSGR_RESET "\n", worker_id);
@@ -49,6 +56,12 @@ void* Threadworker::run_Threadworker_thread(void* p) {
     auto w = static_cast<Threadworker*>(p);
     if(w->verbose) printf(TERMFG_GREEN "  Threadworker [%i] threadjob started." TERMSGR_RESET "\n", w->worker_id);
     _thread_id = w->worker_id;
+    w->thread_init();
+    {
+        lock_guard<mutex> lk(w->inputMut);
+        w->thread_started = true;
+        w->launchReady.notify_all();
+    }
     w->threadjob();
     if(w->verbose) printf(TERMFG_RED "  Threadworker [%i] threadjob completed." TERMSGR_RESET "\n", w->worker_id);
     if(w->myManager) w->myManager->notify_thread_completed(w);
@@ -58,8 +71,71 @@ void* Threadworker::run_Threadworker_thread(void* p) {
 void Threadworker::launch_mythread() {
     if(checkRunning()) throw std::logic_error("Double launch attempted");
     runstat = RUNNING;
-    auto rc = pthread_create(&mythread, nullptr, run_Threadworker_thread, this);
-    if(rc) throw rc;
+    thread_started = false;
+
+    cpu_set_t s;
+    CPU_ZERO(&s);
+    auto cs = cpus.size()? cpus : numa_node >= 0? numaNodeCPUs(numa_node) : vector<int>{};
+    if(cs.size()) {
+        for(auto c: allowedCPUs()) if(std::find(cs.begin(), cs.end(), c) != cs.end()) CPU_SET(c, &s);
+        if(!CPU_COUNT(&s)) printf(TERMFG_YELLOW "Warning: failed to set Threadworker [%i] CPU affinity" TERMSGR_RESET "\n", worker_id);
+        else if(verbose > 1) printf(TERMFG_BLUE "Threadworker [%i] placed on %zu CPUs from %i" TERMSGR_RESET "\n", worker_id, cs.size(), cs[0]);
+    }
+    const cpu_set_t* aff = CPU_COUNT(&s)? &s : nullptr;
+
+    if(pooled) {
+        thread_done = false;
+        try {
+            mythread = WorkerThreadPool::global().submit([this] {
+                run_Threadworker_thread(this);
+                _thread_id = -1;
+            }, aff, [this] {
+                lock_guard<mutex> lk(inputMut);
+                thread_done = true;
+                launchReady.notify_all();
+            });
+        } catch(...) {
+            runstat = IDLE;
+            thread_done = true;
+            throw;
+        }
+    } else {
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+        if(aff && pthread_attr_setaffinity_np(&attr, sizeof(s), aff))
+            printf(TERMFG_YELLOW "Warning: failed to set Threadworker [%i] CPU affinity" TERMSGR_RESET "\n", worker_id);
+        auto rc = pthread_create(&mythread, &attr, run_Threadworker_thread, this);
+        pthread_attr_destroy(&attr);
+        if(rc) {
+            runstat = IDLE;
+            throw rc;
+        }
+    }
+
+    unique_lock<mutex> lk(inputMut);
+    launchReady.wait(lk, [this] { return thread_started; });
+}
+
+bool Threadworker::join_mythread(double timeout_s) {
+    if(pooled) {
+        unique_lock<mutex> lk(inputMut);
+        if(timeout_s < 0) launchReady.wait(lk, [this] { return thread_done; });
+        else launchReady.wait_for(lk, std::chrono::duration<double>(timeout_s), [this] { return thread_done; });
+        return thread_done;
+    }
+
+    if(timeout_s < 0) {
+        int rc = pthread_join(mythread, nullptr);
+        if(rc) printf("Warning: thread %i joined with code %i\n", worker_id, rc);
+        return true;
+    }
+
+    struct timespec ts;
+    if(clock_gettime(CLOCK_REALTIME, &ts)) throw std::runtime_error("clock_gettime failed");
+    timeout_s += ts.tv_nsec*1e-9;
+    ts.tv_nsec = modf(timeout_s, &timeout_s)*1e9;
+    ts.tv_sec += timeout_s;
+    return !pthread_timedjoin_np(mythread, nullptr, &ts);
 }
 
 void Threadworker::pause() {
@@ -109,9 +185,8 @@ void Threadworker::finish_mythread(bool unlaunched_OK) {
     }
     if(verbose > 2) printf(TERMFG_YELLOW "Threadworker [%i] asked to finish..." TERMSGR_RESET "\n", worker_id);
     request_stop();
-    int rc = pthread_join(mythread, nullptr);
+    join_mythread();
     runstat = IDLE;
-    if(rc) printf("Warning: thread %i joined with code %i\n", worker_id, rc);
     if(verbose > 2) printf(TERMFG_RED "Threadworker [%i] is finished." TERMSGR_RESET "\n", worker_id);
 }
 
@@ -119,16 +194,10 @@ void Threadworker::kill_mythread(double timeout_s) {
     if(verbose > 2) printf(TERMFG_YELLOW "Threadworker [%i] demanded to finish..." TERMSGR_RESET "\n", worker_id);
     request_stop();
 
-    struct timespec ts;
-    if(clock_gettime(CLOCK_REALTIME, &ts)) throw std::runtime_error("clock_gettime failed");
-    timeout_s += ts.tv_nsec*1e-9;
-    ts.tv_nsec = modf(timeout_s, &timeout_s)*1e9;
-    ts.tv_sec += timeout_s;
-
-    if(pthread_timedjoin_np(mythread, nullptr, &ts)) {
+    if(!join_mythread(timeout_s)) {
         myManager = nullptr;
         pthread_kill(mythread, SIGKILL);
-        pthread_join(mythread, nullptr);
+        if(!pooled) pthread_join(mythread, nullptr);
         runstat = INDETERMINATE;
     } else runstat = IDLE;
 }
@@ -55,8 +55,14 @@ public:
 
     /// get launch status
     runstatus_t checkRunning() const { return runstat; }
+    /// whether CPU affinity is requested for thread
+    bool hasPlacement() const { return cpus.size() || numa_node >= 0; }
 
     int worker_id;              ///< assignable identification number
+    bool pooled = pool_default; ///< whether to launch threadjob() on shared WorkerThreadPool instead of a dedicated thread
+    static bool pool_default;   ///< default for pooled in newly-constructed workers
+    vector<int> cpus;           ///< CPUs to run launched thread on (empty for any)
+    int numa_node = -1;         ///< NUMA node to run launched thread on, if cpus unspecified (-1 for any)
     ThreadManager* myManager;   ///< link back to manager
     int verbose = 0;            ///< debugging verbosity level
     static int thread_id();     ///< worker_id that launched current thread
@@ -65,14 +71,21 @@ protected:
     /// task to be run in thread; example waiting for halt condition. Override me!
     virtual void threadjob();
 
+    /// per-thread setup run in launched thread before launch_mythread() returns, e.g. for first-touch allocation
+    virtual void thread_init() { }
     /// check for and respond to pause request
     void check_pause();
 
     /// pthreads function for launching processing loop
     static void* run_Threadworker_thread(void* p);
+    /// wait for launched thread completion, up to timeout_s if non-negative; return whether completed
+    bool join_mythread(double timeout_s = -1);
 
     pthread_t mythread;                 ///< identifier for this object's thread
     runstatus_t runstat = IDLE;         ///< current running status
+    bool thread_started = false;        ///< whether launched thread has completed thread_init()
+    bool thread_done = true;            ///< whether pooled threadjob() has returned
+    std::condition_variable launchReady;///< thread_started/thread_done change notifier
     mutex inputMut;                     ///< mutex on input operations
     std::condition_variable inputReady; ///< input conditions change notifier
     mutex pauseMut;                     ///< mutex on pause operations
@@ -0,0 +1,77 @@
+/// @file WorkerThreadPool.cc
+
+#include "WorkerThreadPool.hh"
+#include <thread>
+#include <stdexcept>
+
+WorkerThreadPool& WorkerThreadPool::global() {
+    static auto P = new WorkerThreadPool();
+    return *P;
+}
+
+WorkerThreadPool::WorkerThreadPool(): max_idle(std::max(1U, std::thread::hardware_concurrency())) {
+    CPU_ZERO(&allowed);
+    sched_getaffinity(0, sizeof(allowed), &allowed);
+}
+
+pthread_t WorkerThreadPool::submit(std::function<void()> f, const cpu_set_t* cpus, std::function<void()> done) {
+    std::unique_lock<std::mutex> lk(poolMut);
+    if(idle.size()) {
+        auto s = idle.back();
+        idle.pop_back();
+        s->f = std::move(f);
+        s->done = std::move(done);
+        s->pinned = cpus;
+        if(cpus) s->cpus = *cpus;
+        s->ready.notify_one();
+        ++n_reused;
+        return s->t;
+    }
+    lk.unlock();
+
+    auto s = new slot_t();
+    s->f = std::move(f);
+    s->done = std::move(done);
+    s->pinned = cpus;
+    if(cpus) s->cpus = *cpus;
+    auto rc = pthread_create(&s->t, nullptr, run_slot, s);
+    if(rc) {
+        delete s;
+        throw std::runtime_error("WorkerThreadPool thread creation failed");
+    }
+    pthread_detach(s->t);
+    ++n_spawned;
+    return s->t;
+}
+
+void* WorkerThreadPool::run_slot(void* p) {
+    auto s = static_cast<slot_t*>(p);
+    auto& P = global();
+    std::unique_lock<std::mutex> lk(P.poolMut);
+    while(s->f) {
+        auto f = std::move(s->f);
+        auto done = std::move(s->done);
+        s->f = s->done = nullptr;
+        bool pinned = s->pinned;
+        if(pinned) pthread_setaffinity_np(pthread_self(), sizeof(s->cpus), &s->cpus);
+        lk.unlock();
+
+        f();
+        f = nullptr;
+
+        if(pinned) pthread_setaffinity_np(pthread_self(), sizeof(P.allowed), &P.allowed);
+        lk.lock();
+        bool park = P.idle.size() < P.max_idle;
+        if(park) P.idle.push_back(s);   // available for re-use before completion is reported
+        if(done) {
+            lk.unlock();
+            done();
+            lk.lock();
+        }
+        if(!park) break;
+        s->ready.wait(lk, [s] { return bool(s->f); });
+    }
+    lk.unlock();
+    delete s;
+    return nullptr;
+}
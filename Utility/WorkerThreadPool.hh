@@ -0,0 +1,52 @@
+/// @file WorkerThreadPool.hh Process-wide pool of reusable threads for running Threadworker jobs
+
+#ifndef WORKERTHREADPOOL_HH
+#define WORKERTHREADPOOL_HH
+
+#include <pthread.h>
+#include <sched.h>
+#include <functional>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+#include <atomic>
+
+/// Process-wide pool of reusable threads. Tasks may block indefinitely, so a task
+/// submitted with no idle thread available gets a new thread; finished threads
+/// park for re-use, up to max_idle (default hardware concurrency), then exit.
+class WorkerThreadPool {
+public:
+    /// get process-wide instance (never destructed, so parked threads may outlive static destruction)
+    static WorkerThreadPool& global();
+
+    /// run task on parked or new thread, optionally pinned to CPU set for duration of task; return executing thread.
+    /// Optional done() is called after the thread is parked, ready for re-use by a following submit().
+    pthread_t submit(std::function<void()> f, const cpu_set_t* cpus = nullptr, std::function<void()> done = nullptr);
+
+    size_t max_idle;                    ///< maximum number of parked threads kept for re-use
+    std::atomic<size_t> n_spawned{0};   ///< number of threads created
+    std::atomic<size_t> n_reused{0};    ///< number of tasks run on a re-used thread
+
+protected:
+    /// Constructor
+    WorkerThreadPool();
+
+    /// one pooled thread
+    struct slot_t {
+        pthread_t t;                        ///< the thread
+        std::function<void()> f;            ///< task to run
+        std::function<void()> done;         ///< task completion callback
+        cpu_set_t cpus;                     ///< task CPU affinity
+        bool pinned = false;                ///< whether cpus applies to task
+        std::condition_variable ready;      ///< task assigned notification
+    };
+
+    /// thread loop: run task, park until next task or retirement
+    static void* run_slot(void* p);
+
+    std::mutex poolMut;         ///< lock on idle list and slot task assignment
+    std::vector<slot_t*> idle;  ///< parked threads
+    cpu_set_t allowed;          ///< process default CPU affinity, restored after pinned tasks
+};
+
+#endif
@@ -0,0 +1,191 @@
+/// @file ring_deque.hh Contiguous growable ring buffer with std::deque-like FIFO interface
+
+#ifndef RING_DEQUE_HH
+#define RING_DEQUE_HH
+
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+/// Contiguous growable ring buffer with std::deque-like FIFO (push_back/pop_front) interface
+/// Unlike std::deque, storage is one power-of-two block (better locality, cheap indexing),
+/// but growth invalidates references to elements.
+template<typename T>
+class ring_deque {
+public:
+    typedef T value_type;               ///< element type
+    typedef size_t size_type;           ///< size type
+    typedef std::ptrdiff_t difference_type; ///< index difference type
+    typedef T& reference;               ///< element reference
+    typedef const T& const_reference;   ///< const element reference
+
+    /// random-access iterator
+    template<class RD, typename V>
+    class _iterator {
+    public:
+        using iterator_category = std::random_access_iterator_tag;  ///< for STL iterator interface
+        using value_type = typename std::remove_const<V>::type;     ///< for STL iterator interface
+        using difference_type = std::ptrdiff_t;                     ///< for STL iterator interface
+        using pointer = V*;                                         ///< for STL iterator interface
+        using reference = V&;                                       ///< for STL iterator interface
+
+        /// Constructor
+        _iterator(RD* r = nullptr, size_t _i = 0): R(r), i(_i) { }
+        /// conversion to const_iterator
+        operator _iterator<const RD, const V>() const { return {R, i}; }
+
+        /// dereference
+        reference operator*() const { return (*R)[i]; }
+        /// dereference
+        pointer operator->() const { return &(*R)[i]; }
+        /// offset dereference
+        reference operator[](difference_type n) const { return (*R)[i + n]; }
+
+        /// increment
+        _iterator& operator++() { ++i; return *this; }
+        /// post-increment
+        _iterator operator++(int) { auto o = *this; ++i; return o; }
+        /// decrement
+        _iterator& operator--() { --i; return *this; }
+        /// post-decrement
+        _iterator operator--(int) { auto o = *this; --i; return o; }
+        /// advance
+        _iterator& operator+=(difference_type n) { i += n; return *this; }
+        /// retreat
+        _iterator& operator-=(difference_type n) { i -= n; return *this; }
+        /// offset
+        _iterator operator+(difference_type n) const { return {R, i + n}; }
+        /// offset
+        _iterator operator-(difference_type n) const { return {R, i - n}; }
+        /// distance
+        difference_type operator-(const _iterator& o) const { return difference_type(i) - difference_type(o.i); }
+
+        /// comparison
+        bool operator==(const _iterator& o) const { return i == o.i; }
+        /// comparison
+        bool operator!=(const _iterator& o) const { return i != o.i; }
+        /// comparison
+        bool operator<(const _iterator& o) const { return i < o.i; }
+        /// comparison
+        bool operator>(const _iterator& o) const { return i > o.i; }
+        /// comparison
+        bool operator<=(const _iterator& o) const { return i <= o.i; }
+        /// comparison
+        bool operator>=(const _iterator& o) const { return i >= o.i; }
+
+        /// position index in container
+        size_t index() const { return i; }
+
+    protected:
+        RD* R;      ///< container
+        size_t i;   ///< index in container
+    };
+
+    typedef _iterator<ring_deque, T> iterator;                          ///< iterator
+    typedef _iterator<const ring_deque, const T> const_iterator;        ///< const iterator
+
+    /// Constructor
+    ring_deque() { }
+    /// Copy constructor
+    ring_deque(const ring_deque& r) { reserve(r.size()); for(auto& x: r) push_back(x); }
+    /// Move constructor
+    ring_deque(ring_deque&& r) noexcept { swap(r); }
+    /// Assignment
+    ring_deque& operator=(ring_deque r) { swap(r); return *this; }
+    /// Destructor
+    ~ring_deque() { clear(); if(buf) std::allocator<T>().deallocate(buf, mask + 1); }
+
+    /// swap contents
+    void swap(ring_deque& r) noexcept {
+        std::swap(buf, r.buf);
+        std::swap(mask, r.mask);
+        std::swap(i0, r.i0);
+        std::swap(n, r.n);
+    }
+
+    /// number of elements
+    size_t size() const { return n; }
+    /// check if empty
+    bool empty() const { return !n; }
+    /// allocated capacity
+    size_t capacity() const { return buf? mask + 1 : 0; }
+
+    /// element access
+    T& operator[](size_t i) { return buf[(i0 + i) & mask]; }
+    /// element access
+    const T& operator[](size_t i) const { return buf[(i0 + i) & mask]; }
+    /// bounds-checked element access
+    T& at(size_t i) { if(i >= n) throw std::out_of_range("ring_deque::at"); return (*this)[i]; }
+    /// bounds-checked element access
+    const T& at(size_t i) const { if(i >= n) throw std::out_of_range("ring_deque::at"); return (*this)[i]; }
+    /// first element
+    T& front() { return (*this)[0]; }
+    /// first element
+    const T& front() const { return (*this)[0]; }
+    /// last element
+    T& back() { return (*this)[n - 1]; }
+    /// last element
+    const T& back() const { return (*this)[n - 1]; }
+
+    /// start iterator
+    iterator begin() { return {this, 0}; }
+    /// end iterator
+    iterator end() { return {this, n}; }
+    /// start iterator
+    const_iterator begin() const { return {this, 0}; }
+    /// end iterator
+    const_iterator end() const { return {this, n}; }
+
+    /// construct element at end
+    template<typename... Args>
+    T& emplace_back(Args&&... a) {
+        if(n == capacity()) reserve(n? 2 * n : 1);
+        auto p = buf + ((i0 + n) & mask);
+        new(p) T(std::forward<Args>(a)...);
+        ++n;
+        return *p;
+    }
+    /// add element at end
+    void push_back(const T& x) { emplace_back(x); }
+    /// add element at end
+    void push_back(T&& x) { emplace_back(std::move(x)); }
+    /// remove first element
+    void pop_front() {
+        buf[i0].~T();
+        i0 = (i0 + 1) & mask;
+        --n;
+    }
+    /// remove last element
+    void pop_back() {
+        (*this)[n - 1].~T();
+        --n;
+    }
+    /// remove all elements
+    void clear() { while(n) pop_front(); i0 = 0; }
+
+    /// ensure capacity for at least c elements (rounded up to power of 2)
+    void reserve(size_t c) {
+        if(c <= capacity()) return;
+        size_t c2 = 16;
+        while(c2 < c) c2 <<= 1;
+        auto b = std::allocator<T>().allocate(c2);
+        for(size_t i = 0; i < n; ++i) {
+            new(b + i) T(std::move_if_noexcept((*this)[i]));
+            (*this)[i].~T();
+        }
+        if(buf) std::allocator<T>().deallocate(buf, mask + 1);
+        buf = b;
+        mask = c2 - 1;
+        i0 = 0;
+    }
+
+protected:
+    T* buf = nullptr;   ///< storage
+    size_t mask = 0;    ///< capacity - 1, for index wraparound
+    size_t i0 = 0;      ///< buffer position of first element
+    size_t n = 0;       ///< number of elements
+};
+
+#endif
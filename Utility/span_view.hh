@@ -0,0 +1,65 @@
+/// @file span_view.hh Non-owning view of contiguous array (pre-C++20 std::span stand-in)
+
+#ifndef SPAN_VIEW_HH
+#define SPAN_VIEW_HH
+
+#include <vector>
+using std::vector;
+#include <type_traits>
+#include <cstddef>
+
+/// Non-owning view of contiguous array
+template<typename T>
+class span_view {
+public:
+    /// element type
+    typedef T element_type;
+    /// iterator type
+    typedef T* iterator;
+
+    /// Default constructor, empty span
+    constexpr span_view() { }
+    /// Constructor from pointer and size
+    constexpr span_view(T* p, size_t n): _data(p), _size(n) { }
+    /// Constructor from vector (const-qualifying as needed)
+    template<typename U, typename A, typename = typename std::enable_if<std::is_convertible<U(*)[], T(*)[]>::value>::type>
+    span_view(vector<U,A>& v): _data(v.data()), _size(v.size()) { }
+    /// Constructor from const vector
+    template<typename U, typename A, typename = typename std::enable_if<std::is_convertible<const U(*)[], T(*)[]>::value>::type>
+    span_view(const vector<U,A>& v): _data(v.data()), _size(v.size()) { }
+    /// Constructor from compatible span (e.g. span_view<T> to span_view<const T>)
+    template<typename U, typename = typename std::enable_if<std::is_convertible<U(*)[], T(*)[]>::value>::type>
+    constexpr span_view(const span_view<U>& s): _data(s.data()), _size(s.size()) { }
+
+    /// pointer to first element
+    constexpr T* data() const { return _data; }
+    /// number of elements
+    constexpr size_t size() const { return _size; }
+    /// check if empty
+    constexpr bool empty() const { return !_size; }
+
+    /// element access
+    T& operator[](size_t i) const { return _data[i]; }
+    /// first element
+    T& front() const { return _data[0]; }
+    /// last element
+    T& back() const { return _data[_size - 1]; }
+
+    /// start iterator
+    constexpr iterator begin() const { return _data; }
+    /// end iterator
+    constexpr iterator end() const { return _data + _size; }
+
+    /// sub-range view [i, i+n), truncated at end
+    span_view subspan(size_t i, size_t n = size_t(-1)) const {
+        if(i > _size) i = _size;
+        if(n > _size - i) n = _size - i;
+        return span_view(_data + i, n);
+    }
+
+protected:
+    T* _data = nullptr; ///< start of data
+    size_t _size = 0;   ///< number of elements
+};
+
+#endif
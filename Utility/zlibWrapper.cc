@@ -4,11 +4,11 @@
 #include "zlibWrapper.hh"
 #include <zlib.h>
 
-void deflate(const void* in, size_t n, vector<char>& vout) {
+void deflate(const void* in, size_t n, vector<char>& vout, int level) {
     auto nout = compressBound(n);
     vout.resize(nout);
-    compress(reinterpret_cast<unsigned char*>(vout.data()),
-             &nout, reinterpret_cast<const unsigned char*>(in), n);
+    compress2(reinterpret_cast<unsigned char*>(vout.data()),
+             &nout, reinterpret_cast<const unsigned char*>(in), n, level);
     vout.resize(nout);
 }
 
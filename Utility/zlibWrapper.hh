@@ -8,8 +8,8 @@
 using std::vector;
 #include <cstddef> // for size_t
 
-/// compress n bytes from in to output vector
-void deflate(const void* in, size_t n, vector<char>& out);
+/// compress n bytes from in to output vector, at zlib level (-1 for default, 1 fastest to 9 smallest)
+void deflate(const void* in, size_t n, vector<char>& out, int level = -1);
 /// decompress n bytes from input to (not undersized!) output; return actual nout
 size_t inflate(const void* in, size_t n, void* out, size_t nout);
 